@@ -0,0 +1,244 @@
+#include "ChunkMap.h"
+#include <algorithm>
+#include <limits>
+#include <cfloat>
+namespace ParticleLife {
+    constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+    constexpr uint64_t HASH_MULTIPLIER = 0x9e3779b97f4a7c15ull;
+    constexpr size_t MIN_SLOTS = 16;
+    /// @brief the table is kept at most half full
+    constexpr size_t SLOTS_PER_CHUNK = 2;
+    const ChunkMap::Box EMPTY_BOX = {
+        { std::numeric_limits<float>::max(), std::numeric_limits<float>::max() },
+        { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() }
+    };
+    /// @brief box distances are reduced by this many units of rounding error of the world size along each axis
+    constexpr float BOX_TOLERANCE_ULPS = 4;
+
+    ChunkMap::ChunkMap() : slotKeys_(), slotChunks_(), chunks_(), particles_(), bounds_(), boxes_(), particleChunks_(), speciesCount_(0), chunkSize_(0), chunkCount_(0) {}
+
+    /// @brief put a zero bit between each two bits of a 32 bit number
+    static uint64_t spreadBits(uint64_t x) {
+        x = (x | x << 16) & 0x0000ffff0000ffffull;
+        x = (x | x << 8) & 0x00ff00ff00ff00ffull;
+        x = (x | x << 4) & 0x0f0f0f0f0f0f0f0full;
+        x = (x | x << 2) & 0x3333333333333333ull;
+        x = (x | x << 1) & 0x5555555555555555ull;
+        return x;
+    }
+    /// @brief inverse of spreadBits, ignores odd bits
+    static uint64_t compactBits(uint64_t x) {
+        x &= 0x5555555555555555ull;
+        x = (x | x >> 1) & 0x3333333333333333ull;
+        x = (x | x >> 2) & 0x0f0f0f0f0f0f0f0full;
+        x = (x | x >> 4) & 0x00ff00ff00ff00ffull;
+        x = (x | x >> 8) & 0x0000ffff0000ffffull;
+        x = (x | x >> 16) & 0x00000000ffffffffull;
+        return x;
+    }
+
+    uint64_t ChunkMap::getKey(size_t chunkX, size_t chunkY) {
+        return spreadBits(chunkX) << 1 | spreadBits(chunkY);
+    }
+    size_t ChunkMap::getChunkX(uint64_t key) {
+        return compactBits(key >> 1);
+    }
+    size_t ChunkMap::getChunkY(uint64_t key) {
+        return compactBits(key);
+    }
+
+    size_t ChunkMap::findSlot(uint64_t key) const {
+        size_t mask = slotKeys_.size() - 1;
+        size_t slot = (key * HASH_MULTIPLIER) >> 32 & mask;
+        while (slotKeys_[slot] != key && slotKeys_[slot] != EMPTY_KEY) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    size_t ChunkMap::findOrAddChunk(uint64_t key) {
+        size_t slot = findSlot(key);
+        if (slotKeys_[slot] == key)
+            return slotChunks_[slot];
+        if ((chunks_.size() + 1) * SLOTS_PER_CHUNK > slotKeys_.size()) {
+            resetSlots(slotKeys_.size() * 2);
+            for (size_t i = 0; i < chunks_.size(); i++)
+            {
+                size_t s = findSlot(chunks_[i].key);
+                slotKeys_[s] = chunks_[i].key;
+                slotChunks_[s] = i;
+            }
+            slot = findSlot(key);
+        }
+        slotKeys_[slot] = key;
+        slotChunks_[slot] = chunks_.size();
+        chunks_.push_back({ key, bounds_.size() });
+        bounds_.resize(bounds_.size() + speciesCount_ + 1);
+        boxes_.resize(bounds_.size(), EMPTY_BOX);
+        return chunks_.size() - 1;
+    }
+
+    void ChunkMap::resetSlots(size_t capacity) {
+        slotKeys_.assign(capacity, EMPTY_KEY);
+        slotChunks_.resize(capacity);
+    }
+
+    void ChunkMap::build(std::vector<ParticleVector>& particles, const SimulationParameters& parameters) {
+        // size the table for the previous amount of chunks, it grows if needed
+        size_t capacity = MIN_SLOTS;
+        while (capacity < chunks_.size() * SLOTS_PER_CHUNK * 2)
+            capacity *= 2;
+        resetSlots(capacity);
+        chunks_.clear();
+        bounds_.clear();
+        boxes_.clear();
+        speciesCount_ = particles.size();
+        chunkSize_ = parameters.chunkSize;
+        chunkCount_ = parameters.chunkCount;
+
+        size_t total = 0;
+        for (auto&& s : particles)
+            total += s.size();
+        particleChunks_.resize(total);
+
+        // count particles of each species in each chunk, the count of species s is stored in place of bound s + 1, and grow the boxes of their species
+        size_t i = 0;
+        for (size_t s = 0; s < particles.size(); s++)
+        {
+            for (auto&& p : particles[s]) {
+                sf::Vector2f position = p.getPosition();
+                size_t x = std::min((size_t)std::floorf(position.x / parameters.chunkSize), parameters.chunkCount - 1);
+                size_t y = std::min((size_t)std::floorf(position.y / parameters.chunkSize), parameters.chunkCount - 1);
+                size_t c = findOrAddChunk(getKey(x, y));
+                bounds_[chunks_[c].bounds + s + 1]++;
+                particleChunks_[i++] = chunks_[c].bounds;
+                Box& box = boxes_[chunks_[c].bounds + s];
+                box.min.x = std::min(box.min.x, position.x);
+                box.min.y = std::min(box.min.y, position.y);
+                box.max.x = std::max(box.max.x, position.x);
+                box.max.y = std::max(box.max.y, position.y);
+            }
+        }
+        for (auto&& c : chunks_) {
+            Box& all = boxes_[c.bounds + speciesCount_];
+            for (size_t s = 0; s < speciesCount_; s++)
+            {
+                const Box& box = boxes_[c.bounds + s];
+                all.min.x = std::min(all.min.x, box.min.x);
+                all.min.y = std::min(all.min.y, box.min.y);
+                all.max.x = std::max(all.max.x, box.max.x);
+                all.max.y = std::max(all.max.y, box.max.y);
+            }
+        }
+
+        // lay the chunks out along the Z-order curve, so that chunks close in space are also close in memory
+        std::sort(chunks_.begin(), chunks_.end(), [](const Chunk& a, const Chunk& b) { return a.key < b.key; });
+        std::fill(slotKeys_.begin(), slotKeys_.end(), EMPTY_KEY);
+        for (size_t c = 0; c < chunks_.size(); c++)
+        {
+            size_t slot = findSlot(chunks_[c].key);
+            slotKeys_[slot] = chunks_[c].key;
+            slotChunks_[slot] = c;
+        }
+
+        // turn counts into bounds, bound s is then used as a cursor while filling species s
+        size_t begin = 0;
+        for (auto&& c : chunks_) {
+            for (size_t s = 0; s < speciesCount_; s++)
+            {
+                size_t count = bounds_[c.bounds + s + 1];
+                bounds_[c.bounds + s] = begin;
+                begin += count;
+            }
+            bounds_[c.bounds + speciesCount_] = begin;
+        }
+
+        particles_.resize(total);
+        i = 0;
+        for (size_t s = 0; s < particles.size(); s++)
+        {
+            for (auto&& p : particles[s]) {
+                particles_[bounds_[particleChunks_[i++] + s]++] = &p;
+            }
+        }
+
+        // the cursors now point at the beginning of the next species
+        for (auto&& c : chunks_) {
+            for (size_t s = speciesCount_; s > 0; s--)
+            {
+                bounds_[c.bounds + s] = bounds_[c.bounds + s - 1];
+            }
+        }
+        begin = 0;
+        for (auto&& c : chunks_) {
+            bounds_[c.bounds] = begin;
+            begin = bounds_[c.bounds + speciesCount_];
+        }
+    }
+
+    void ChunkMap::relocate(std::vector<ParticleVector>& particles) {
+        std::vector<size_t> cursors(speciesCount_);
+        for (auto&& c : chunks_) {
+            for (size_t s = 0; s < speciesCount_; s++)
+            {
+                for (size_t i = getBegin(c, s); i < getEnd(c, s); i++)
+                {
+                    particles_[i] = &particles[s][cursors[s]++];
+                }
+            }
+        }
+    }
+
+    size_t ChunkMap::countScattered() const {
+        size_t scattered = 0;
+        for (auto&& c : chunks_) {
+            for (size_t s = 0; s < speciesCount_; s++)
+            {
+                for (size_t i = getBegin(c, s) + 1; i < getEnd(c, s); i++)
+                {
+                    if (particles_[i] != particles_[i - 1] + 1)
+                        scattered++;
+                }
+            }
+        }
+        return scattered;
+    }
+
+    float ChunkMap::getDistanceSquared(const Box& box, const Box& other, float worldSize) {
+        float tolerance = worldSize * FLT_EPSILON * BOX_TOLERANCE_ULPS;
+        // gap between the boxes along one axis, also trying the other box moved across each edge of the world
+        auto getGap = [worldSize, tolerance](float min, float max, float otherMin, float otherMax) {
+            float gap = std::max(otherMin - max, min - otherMax);
+            gap = std::min(gap, std::max(otherMin + worldSize - max, min - otherMax - worldSize));
+            gap = std::min(gap, std::max(otherMin - worldSize - max, min - otherMax + worldSize));
+            return std::max(gap - tolerance, 0.0f);
+        };
+        float x = getGap(box.min.x, box.max.x, other.min.x, other.max.x);
+        float y = getGap(box.min.y, box.max.y, other.min.y, other.max.y);
+        return x * x + y * y;
+    }
+
+    const std::vector<ChunkMap::Chunk>& ChunkMap::getChunks() const {
+        return chunks_;
+    }
+
+    const ChunkMap::Chunk* ChunkMap::find(uint64_t key) const {
+        size_t slot = findSlot(key);
+        if (slotKeys_[slot] == EMPTY_KEY)
+            return nullptr;
+        return &chunks_[slotChunks_[slot]];
+    }
+
+    void ChunkMap::findRotations(const Chunk& chunk, sf::Vector2u offset, size_t chunkCount, const Chunk* (&others)[ROTATIONS]) const {
+        size_t chunkX = getChunkX(chunk.key);
+        size_t chunkY = getChunkY(chunk.key);
+        others[0] = find(getKey((chunkX + offset.x) % chunkCount, (chunkY + offset.y) % chunkCount));
+        others[1] = find(getKey((chunkX + offset.y) % chunkCount, (chunkY + chunkCount - offset.x) % chunkCount));
+        others[2] = find(getKey((chunkX + chunkCount - offset.x) % chunkCount, (chunkY + chunkCount - offset.y) % chunkCount));
+        others[3] = find(getKey((chunkX + chunkCount - offset.y) % chunkCount, (chunkY + offset.x) % chunkCount));
+    }
+
+    const std::vector<Particle*>& ChunkMap::getParticles() const {
+        return particles_;
+    }
+}
\ No newline at end of file
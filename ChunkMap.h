@@ -0,0 +1,99 @@
+#ifndef CHUNK_MAP_H
+#define CHUNK_MAP_H
+#include "Particle.h"
+#include "SimulationParameters.h"
+#include <vector>
+#include <cstdint>
+namespace ParticleLife {
+    /// @brief sparse index of particles by chunk and species, only occupied chunks take up memory and time
+    class ChunkMap {
+    public:
+        /// @brief number of rotations of a chunk pattern offset, together they cover all directions
+        static constexpr size_t ROTATIONS = 4;
+        /// @brief chunk containing at least one particle
+        struct Chunk {
+            /// @brief chunk coordinates packed by getKey, chunks are sorted by it
+            uint64_t key;
+            /// @brief index of the first of this chunk's particle ranges in bounds_
+            size_t bounds;
+        };
+        /// @brief smallest rectangle containing some particles, min is greater than max if there are none
+        struct Box {
+            sf::Vector2f min;
+            sf::Vector2f max;
+        };
+    private:
+        /// @brief keys of the open addressing hash table, EMPTY_KEY marks free slots
+        std::vector<uint64_t> slotKeys_;
+        /// @brief chunk indices of the open addressing hash table
+        std::vector<size_t> slotChunks_;
+        /// @brief occupied chunks sorted by key, so along the Z-order curve
+        std::vector<Chunk> chunks_;
+        /// @brief particles grouped by chunks and within each chunk sorted by species
+        std::vector<Particle*> particles_;
+        /// @brief for each chunk, index of the first particle of each species followed by index after the chunk's last particle
+        std::vector<size_t> bounds_;
+        /// @brief at the same indices as bounds_, box of each species of the chunk followed by the box of all of them
+        std::vector<Box> boxes_;
+        /// @brief index of the chunk's bounds of each particle in order of the input, reused between builds
+        std::vector<size_t> particleChunks_;
+        /// @brief number of species in the last build
+        size_t speciesCount_;
+        /// @brief chunk size of the last build
+        float chunkSize_;
+        /// @brief number of chunks along each axis in the last build
+        size_t chunkCount_;
+        /// @brief get slot where the key is or would be stored
+        size_t findSlot(uint64_t key) const;
+        /// @brief get index of the chunk with this key, creating an empty one if there is none
+        size_t findOrAddChunk(uint64_t key);
+        /// @brief clear the hash table and resize it to given capacity (power of two)
+        void resetSlots(size_t capacity);
+    public:
+        ChunkMap();
+        /// @brief pack chunk coordinates into one key by interleaving their bits, ordering chunks along the Z-order (Morton) curve
+        static uint64_t getKey(size_t chunkX, size_t chunkY);
+        /// @brief get horizontal chunk coordinate from a key
+        static size_t getChunkX(uint64_t key);
+        /// @brief get vertical chunk coordinate from a key
+        static size_t getChunkY(uint64_t key);
+        /// @brief assign particles to corresponding chunks
+        /// @param particles particles split by species
+        /// @param parameters parameters of the current tick
+        void build(std::vector<ParticleVector>& particles, const SimulationParameters& parameters);
+        /// @brief point to the same particles after they were moved, expects each species to be stored in the same order as in this map
+        /// @param particles particles split by species, in the order of this map
+        void relocate(std::vector<ParticleVector>& particles);
+        /// @brief count particles which don't directly follow the previous particle of the same chunk and species in memory
+        size_t countScattered() const;
+        /// @brief get all occupied chunks
+        const std::vector<Chunk>& getChunks() const;
+        /// @brief get chunk size the map was built with
+        inline float getChunkSize() const { return chunkSize_; }
+        /// @brief get number of chunks along each axis the map was built with
+        inline size_t getChunkCount() const { return chunkCount_; }
+        /// @brief find chunk by key
+        /// @return pointer to the chunk or nullptr if it is empty
+        const Chunk* find(uint64_t key) const;
+        /// @brief find chunks at given offset from a chunk, rotated by 0, 90, 180 and 270 degrees, wrapping around the world
+        /// @param chunk occupied chunk
+        /// @param offset chunk pattern offset
+        /// @param chunkCount number of chunks along each axis
+        /// @param others found chunks, nullptr for empty ones
+        void findRotations(const Chunk& chunk, sf::Vector2u offset, size_t chunkCount, const Chunk* (&others)[ROTATIONS]) const;
+        /// @brief get particles grouped by chunks and species, indexed by getBegin and getEnd
+        const std::vector<Particle*>& getParticles() const;
+        /// @brief get index of the first particle of given species in given chunk
+        inline size_t getBegin(const Chunk& chunk, size_t species) const { return bounds_[chunk.bounds + species]; }
+        /// @brief get index after the last particle of given species in given chunk
+        inline size_t getEnd(const Chunk& chunk, size_t species) const { return bounds_[chunk.bounds + species + 1]; }
+        /// @brief get box of the particles of given species in given chunk at the time of the build
+        inline const Box& getBox(const Chunk& chunk, size_t species) const { return boxes_[chunk.bounds + species]; }
+        /// @brief get box of all particles in given chunk at the time of the build
+        inline const Box& getBox(const Chunk& chunk) const { return boxes_[chunk.bounds + speciesCount_]; }
+        /// @brief get the squared distance between the closest points of two non-empty boxes, wrapping around the world
+        /// @details slightly underestimated, so that no two particles in the boxes are closer in the force pass, despite its different rounding
+        static float getDistanceSquared(const Box& box, const Box& other, float worldSize);
+    };
+}
+#endif
\ No newline at end of file
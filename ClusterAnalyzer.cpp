@@ -0,0 +1,189 @@
+#include "ClusterAnalyzer.h"
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <bit>
+namespace ParticleLife {
+    /// @brief number of largest clusters to report
+    constexpr size_t LARGEST_CLUSTERS = 5;
+
+    ClusterAnalyzer::ClusterAnalyzer() : chunks_(), positions_(), parameters_(), time_(0), sliceCount_(0), linkedSlices_(0), parents_() {}
+
+    size_t ClusterAnalyzer::find(size_t particle)
+    {
+        while (true) {
+            size_t parent = std::atomic_ref<size_t>(parents_[particle]).load(std::memory_order_relaxed);
+            if (parent == particle)
+                return particle;
+            size_t grandparent = std::atomic_ref<size_t>(parents_[parent]).load(std::memory_order_relaxed);
+            // parents only ever point to lower indices, so skipping to the grandparent can't form a cycle even if it races with a union
+            if (grandparent != parent)
+                std::atomic_ref<size_t>(parents_[particle]).compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+            particle = grandparent;
+        }
+    }
+
+    void ClusterAnalyzer::unite(size_t particle, size_t other)
+    {
+        while (true) {
+            particle = find(particle);
+            other = find(other);
+            if (particle == other)
+                return;
+            // always attach the higher root below the lower one, so no cycles can form
+            if (particle < other)
+                std::swap(particle, other);
+            size_t expected = particle;
+            if (std::atomic_ref<size_t>(parents_[particle]).compare_exchange_strong(expected, other, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+    void ClusterAnalyzer::linkChunks(const ChunkMap::Chunk& chunk, const ChunkMap::Chunk& otherChunk)
+    {
+        const SimulationParameters& parameters = *parameters_;
+        size_t speciesCount = parameters.species.size();
+        size_t begin = chunks_.getBegin(chunk, 0);
+        size_t end = chunks_.getEnd(chunk, speciesCount - 1);
+        size_t otherBegin = chunks_.getBegin(otherChunk, 0);
+        size_t otherEnd = chunks_.getEnd(otherChunk, speciesCount - 1);
+        float linkingDistanceSquared = parameters.clusterLinkingDistance * parameters.clusterLinkingDistance;
+        float halfWorldSize = parameters.worldSize / 2;
+        for (size_t i = begin; i < end; i++)
+        {
+            sf::Vector2f position = positions_[i];
+            // within the same chunk, each pair is checked once
+            for (size_t j = &chunk == &otherChunk ? i + 1 : otherBegin; j < otherEnd; j++)
+            {
+                sf::Vector2f diff = positions_[j] - position;
+                if (diff.x < -halfWorldSize)
+                    diff.x += parameters.worldSize;
+                else if (diff.x > halfWorldSize)
+                    diff.x -= parameters.worldSize;
+                if (diff.y < -halfWorldSize)
+                    diff.y += parameters.worldSize;
+                else if (diff.y > halfWorldSize)
+                    diff.y -= parameters.worldSize;
+                if (diff.x * diff.x + diff.y * diff.y < linkingDistanceSquared)
+                    unite(i, j);
+            }
+        }
+    }
+
+    void ClusterAnalyzer::start(const ChunkMap& chunks, const std::shared_ptr<const SimulationParameters>& parameters, WorkerPool& workers, double time, size_t sliceCount)
+    {
+        // the map and positions are copied, so the slices linked in later ticks see the particles as they were now
+        chunks_ = chunks;
+        parameters_ = parameters;
+        time_ = time;
+        sliceCount_ = std::max((size_t)1, sliceCount);
+        linkedSlices_ = 0;
+        const std::vector<Particle*>& particles = chunks.getParticles();
+        size_t particleCount = particles.size();
+        positions_.resize(particleCount);
+        parents_.resize(particleCount);
+        size_t taskCount = std::max((size_t)1, workers.getThreadCount());
+        workers.run(taskCount, [&](size_t task)
+        {
+            for (size_t i = particleCount * task / taskCount; i < particleCount * (task + 1) / taskCount; i++)
+            {
+                positions_[i] = particles[i]->getPosition();
+                parents_[i] = i;
+            }
+        });
+    }
+
+    void ClusterAnalyzer::stop()
+    {
+        parameters_.reset();
+    }
+
+    std::optional<ClusterReport> ClusterAnalyzer::advance(WorkerPool& workers)
+    {
+        if (!isRunning())
+            return std::nullopt;
+        const SimulationParameters& parameters = *parameters_;
+        const std::vector<ChunkMap::Chunk>& chunkList = chunks_.getChunks();
+        size_t sliceBegin = chunkList.size() * linkedSlices_ / sliceCount_;
+        size_t sliceEnd = chunkList.size() * (linkedSlices_ + 1) / sliceCount_;
+        size_t sliceSize = sliceEnd - sliceBegin;
+        size_t taskCount = std::max((size_t)1, workers.getThreadCount());
+        workers.run(taskCount, [&](size_t task)
+        {
+            for (size_t c = sliceBegin + sliceSize * task / taskCount; c < sliceBegin + sliceSize * (task + 1) / taskCount; c++)
+            {
+                linkChunks(chunkList[c], chunkList[c]);
+                for (size_t i = 0; i < parameters.clusterChunkRange; i++)
+                {
+                    const ChunkMap::Chunk* others[ChunkMap::ROTATIONS];
+                    chunks_.findRotations(chunkList[c], parameters.chunkPattern[i], parameters.chunkCount, others);
+                    for (auto&& other : others) {
+                        // each pair of neighbouring chunks is found from both sides, only the lower one links them
+                        if (other != nullptr && other > &chunkList[c])
+                            linkChunks(chunkList[c], *other);
+                    }
+                }
+            }
+        });
+        linkedSlices_++;
+        if (linkedSlices_ < sliceCount_)
+            return std::nullopt;
+        ClusterReport result = report(workers);
+        parameters_.reset();
+        return result;
+    }
+
+    ClusterReport ClusterAnalyzer::report(WorkerPool& workers)
+    {
+        const std::vector<ChunkMap::Chunk>& chunkList = chunks_.getChunks();
+        size_t particleCount = positions_.size();
+        size_t speciesCount = parameters_->species.size();
+        size_t taskCount = std::max((size_t)1, workers.getThreadCount());
+        workers.run(taskCount, [&](size_t task)
+        {
+            for (size_t i = particleCount * task / taskCount; i < particleCount * (task + 1) / taskCount; i++)
+            {
+                std::atomic_ref<size_t>(parents_[i]).store(find(i), std::memory_order_relaxed);
+            }
+        });
+
+        ClusterReport report = { time_, parameters_->clusterLinkingDistance, particleCount, 0, {}, {} };
+        std::vector<size_t> sizes(particleCount);
+        for (auto&& root : parents_) {
+            sizes[root]++;
+        }
+        std::vector<std::pair<size_t, size_t>> roots;
+        for (size_t i = 0; i < particleCount; i++)
+        {
+            if (parents_[i] != i)
+                continue;
+            size_t bucket = std::bit_width(sizes[i]) - 1;
+            if (report.sizeHistogram.size() <= bucket)
+                report.sizeHistogram.resize(bucket + 1);
+            report.sizeHistogram[bucket]++;
+            roots.emplace_back(sizes[i], i);
+        }
+        report.clusterCount = roots.size();
+
+        size_t largestCount = std::min(LARGEST_CLUSTERS, roots.size());
+        std::partial_sort(roots.begin(), roots.begin() + largestCount, roots.end(), std::greater<>());
+        for (size_t i = 0; i < largestCount; i++)
+        {
+            report.largest.push_back({ roots[i].first, std::vector<size_t>(speciesCount) });
+        }
+        for (auto&& c : chunkList) {
+            for (size_t s = 0; s < speciesCount; s++)
+            {
+                for (size_t i = chunks_.getBegin(c, s); i < chunks_.getEnd(c, s); i++)
+                {
+                    for (size_t l = 0; l < largestCount; l++)
+                    {
+                        if (parents_[i] == roots[l].second)
+                            report.largest[l].speciesCounts[s]++;
+                    }
+                }
+            }
+        }
+        return report;
+    }
+}
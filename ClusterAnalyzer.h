@@ -0,0 +1,76 @@
+#ifndef CLUSTER_ANALYZER_H
+#define CLUSTER_ANALYZER_H
+#include "ChunkMap.h"
+#include "SimulationParameters.h"
+#include "WorkerPool.h"
+#include <vector>
+#include <memory>
+#include <optional>
+namespace ParticleLife {
+    /// @brief summary of clusters - groups of particles connected by chains of particles closer than the linking distance
+    struct ClusterReport {
+        struct Cluster {
+            /// @brief number of particles
+            size_t size;
+            /// @brief number of particles of each species
+            std::vector<size_t> speciesCounts;
+        };
+        /// @brief simulated time of the analysis
+        double time;
+        float linkingDistance;
+        size_t particleCount;
+        size_t clusterCount;
+        /// @brief number of clusters with size from 2^i to 2^(i+1) - 1
+        std::vector<size_t> sizeHistogram;
+        /// @brief largest clusters, from the largest
+        std::vector<Cluster> largest;
+    };
+
+    /// @brief finds clusters of particles in parallel, looking for neighbours through the chunk map,
+    /// the work is spread over several ticks by linking a slice of the chunks of a snapshot each tick
+    class ClusterAnalyzer {
+    private:
+        /// @brief chunk map of the snapshot, its particle pointers aren't used as the particles move on
+        ChunkMap chunks_;
+        /// @brief positions of the particles of the snapshot in the order of the chunk map
+        std::vector<sf::Vector2f> positions_;
+        /// @brief parameters of the snapshot, nullptr if no analysis is running
+        std::shared_ptr<const SimulationParameters> parameters_;
+        /// @brief simulated time of the snapshot
+        double time_;
+        /// @brief number of slices the chunks are linked in
+        size_t sliceCount_;
+        /// @brief number of slices linked so far
+        size_t linkedSlices_;
+        /// @brief union-find parent of each particle in the order of the chunk map, modified concurrently
+        std::vector<size_t> parents_;
+        /// @brief get the root of the particle's set, halving the path to it
+        size_t find(size_t particle);
+        /// @brief merge the sets of two particles, lock free
+        void unite(size_t particle, size_t other);
+        /// @brief merge sets of particles within linking distance in two chunks
+        /// @param chunk occupied chunk
+        /// @param otherChunk occupied chunk, may be the same one
+        void linkChunks(const ChunkMap::Chunk& chunk, const ChunkMap::Chunk& otherChunk);
+        /// @brief summarize the sets once all chunks are linked
+        ClusterReport report(WorkerPool& workers);
+    public:
+        ClusterAnalyzer();
+        /// @brief take a snapshot of the particles and start finding clusters among them
+        /// @param chunks chunk map built from current positions
+        /// @param parameters parameters of the current tick
+        /// @param workers threads to copy the positions on
+        /// @param time simulated time
+        /// @param sliceCount number of calls of advance the chunks are linked in
+        void start(const ChunkMap& chunks, const std::shared_ptr<const SimulationParameters>& parameters, WorkerPool& workers, double time, size_t sliceCount);
+        /// @brief link the next slice of chunks of the snapshot
+        /// @param workers threads to run on
+        /// @return report of the snapshot after its last slice, nothing before
+        std::optional<ClusterReport> advance(WorkerPool& workers);
+        /// @brief is an analysis started and not finished yet
+        inline bool isRunning() const { return parameters_ != nullptr; }
+        /// @brief abandon the running analysis
+        void stop();
+    };
+}
+#endif
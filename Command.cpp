@@ -1,509 +1,1194 @@
-#include "Command.h"
-#include <iostream>
-#include <format>
-#include <iomanip>
-#include <sstream>
-namespace ParticleLife {
-    constexpr float MAX_WORLD_SIZE = 1e9;
-    constexpr size_t MAX_CHUNKS = 1000;
-    constexpr size_t MIN_WORLD_SIZE_RATIO = 3;
-
-    constexpr size_t TABLE_CELL_WIDTH = 7;
-    constexpr size_t TABLE_CELL_SPACING = 3;
-    constexpr size_t MIN_INTEGER_PART_WIDTH = 2;
-    constexpr size_t SPECIES_ID_WIDTH = 2;
-    constexpr size_t HEADER_SPACING_WIDTH = 5;
-
-    bool FPSCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        float fps;
-        if (!parser_.parseNonNegativeFloat(getArguments()[0], args[1], fps))
-            return false;
-        options.setFPS(fps);
-        return true;
-    }
-
-    void FPSCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "Target FPS: " << 1 / options.getFrameTime() << std::endl;
-    }
-
-    void FPSCommand::printCommandDescription() const
-    {
-        std::cout << "Set target frames per second." << std::endl;
-    }
-
-    std::vector<std::string> FPSCommand::getArguments() const
-    {
-        return { "FPS" };
-    }
-
-    bool ColorCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        size_t s, r, g, b;
-        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
-            return false;
-        if (!parser_.parseSizeT(getArguments()[1], args[2], r, 255))
-            return false;
-        if (!parser_.parseSizeT(getArguments()[2], args[3], g, 255))
-            return false;
-        if (!parser_.parseSizeT(getArguments()[3], args[4], b, 255))
-            return false;
-        options.setSpeciesColor(s, { (sf::Uint8)r,(sf::Uint8)g,(sf::Uint8)b });
-        return true;
-    }
-
-    void ColorCommand::printCurrentSettings(const Options& options) const
-    {
-        for (size_t i = 0; i < options.getSpeciesCount(); i++)
-        {
-            sf::Color c = options.getSpecies(i).color;
-            std::cout << "Color of species " << i << ": " << (size_t)c.r << " " << (size_t)c.g << " " << (size_t)c.b << std::endl;
-        }
-    }
-
-    void ColorCommand::printCommandDescription() const
-    {
-        std::cout << "Set the display color of a particle species." << std::endl;
-    }
-
-    std::vector<std::string> ColorCommand::getArguments() const
-    {
-        return { "species", "R", "G", "B" };
-    }
-
-    bool HelpCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        for (auto&& e : commands_) {
-            std::cout << " - " << e.first << ": ";
-            e.second->printCommandDescription();
-        }
-        return true;
-    }
-
-
-    void HelpCommand::printCommandDescription() const
-    {
-        std::cout << "Prints this table." << std::endl;
-    }
-
-
-    bool ExitCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        exit(0);
-    }
-
-
-    void ExitCommand::printCommandDescription() const
-    {
-        std::cout << "Exit this application." << std::endl;
-    }
-
-
-    bool StepCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        options.paused = true;
-        options.step = true;
-        return true;
-    }
-
-
-    void StepCommand::printCommandDescription() const
-    {
-        std::cout << "Run a single tick of simulation." << std::endl;
-    }
-
-
-    bool PauseCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        options.paused = !options.paused;
-        return true;
-    }
-
-    void PauseCommand::printCommandDescription() const
-    {
-        std::cout << "Pause or unpause the simulation." << std::endl;
-    }
-
-
-    bool RepulsionRangeCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        size_t s, os;
-        float r;
-        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
-            return false;
-        if (!parser_.parseSizeT(getArguments()[1], args[2], os, options.getSpeciesCount() - 1))
-            return false;
-        if (!parser_.parseFloat(getArguments()[2], args[3], r, 0, options.getSpecies(s).attractionRange[os]))
-            return false;
-        options.setSpeciesRepulsionRange(s, os, r);
-        return true;
-    }
-
-    void RepulsionRangeCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "Repulsion range:" << std::endl;
-        std::vector<std::vector<float>> values;
-        for (size_t i = 0; i < options.getSpeciesCount(); i++)
-        {
-            values.push_back(options.getSpecies(i).repulsionRange);
-        }
-        Tabulate(std::move(values));
-    }
-
-    void RepulsionRangeCommand::printCommandDescription() const
-    {
-        std::cout << "Set the distance at which particles of given species start being repelled from particles of the other species. Must be less than the corresponding attraction range." << std::endl;
-    }
-
-    std::vector<std::string> RepulsionRangeCommand::getArguments() const
-    {
-        return { "species id", "other species id", "repulsion range" };
-    }
-
-    bool AttractionRangeCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        size_t s, os;
-        float r;
-        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
-            return false;
-        if (!parser_.parseSizeT(getArguments()[1], args[2], os, options.getSpeciesCount() - 1))
-            return false;
-        if (!parser_.parseFloat(getArguments()[2], args[3], r, options.getSpecies(s).repulsionRange[os], options.getWorldSize() / MIN_WORLD_SIZE_RATIO))
-            return false;
-        options.setSpeciesAttractionRange(s, os, r);
-        return true;
-    }
-
-    void AttractionRangeCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "Attraction range:" << std::endl;
-        std::vector<std::vector<float>> values;
-        for (size_t i = 0; i < options.getSpeciesCount(); i++)
-        {
-            values.push_back(options.getSpecies(i).attractionRange);
-        }
-        Tabulate(std::move(values));
-    }
-
-    void AttractionRangeCommand::printCommandDescription() const
-    {
-        std::cout << "Set the distance at which particles of given species start being attracted to particles of the other species. Must be more than the corresponding repulsion range and less than third of world size." << std::endl;
-    }
-
-    std::vector<std::string> AttractionRangeCommand::getArguments() const
-    {
-        return { "species id", "other species id", "attraction range" };
-    }
-
-    bool AttractionCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        size_t s, os;
-        float r;
-        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
-            return false;
-        if (!parser_.parseSizeT(getArguments()[1], args[2], os, options.getSpeciesCount() - 1))
-            return false;
-        if (!parser_.parseFloat(getArguments()[2], args[3], r))
-            return false;
-        options.setSpeciesAttraction(s, os, r);
-        return true;
-    }
-
-    void AttractionCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "Attraction strength:" << std::endl;
-        std::vector<std::vector<float>> values;
-        for (size_t i = 0; i < options.getSpeciesCount(); i++)
-        {
-            values.push_back(options.getSpecies(i).attraction);
-        }
-        Tabulate(std::move(values));
-    }
-
-    void AttractionCommand::printCommandDescription() const
-    {
-        std::cout << "Set the peak strength of attraction of particles of given species to particles of the other species. Can be negative, then the particles are repelled instead." << std::endl;
-    }
-
-    std::vector<std::string> AttractionCommand::getArguments() const
-    {
-        return { "species id", "other species id", "attraction strength" };
-    }
-
-    bool AddSpeciesCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        size_t c;
-        if (!parser_.parseSizeT(getArguments()[0], args[1], c))
-            return false;
-        options.addRandomSpecies(c);
-        return true;
-    }
-
-    void AddSpeciesCommand::printCommandDescription() const
-    {
-        std::cout << "Add a new particle species with given particle count." << std::endl;
-    }
-
-    std::vector<std::string> AddSpeciesCommand::getArguments() const
-    {
-        return { "count" };
-    }
-
-    bool ChunkCountCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        size_t c;
-        if (!parser_.parseSizeT(getArguments()[0], args[1], c, MIN_WORLD_SIZE_RATIO, MAX_CHUNKS))
-            return false;
-        options.setChunkCount(c);
-        return true;
-    }
-
-    void ChunkCountCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "The world is split into " << options.getChunkCount() << " by " << options.getChunkCount() << " chunks. Their size is " << options.getChunkSize() << "x" << options.getChunkSize() << "." << std::endl;
-    }
-
-    void ChunkCountCommand::printCommandDescription() const
-    {
-        std::cout << "The world will be split along each axis into a given amount of chunks. This setting won't affect the simulation, but will affect computation time." << std::endl;
-    }
-
-    std::vector<std::string> ChunkCountCommand::getArguments() const
-    {
-        return { "amount" };
-    }
-
-    bool RepulsionCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        float r;
-        if (!parser_.parsePositiveFloat(getArguments()[0], args[1], r))
-            return false;
-        options.setRepulsion(r);
-        return true;
-    }
-
-    void RepulsionCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "Peak repulsion strength: " << options.getRepulsion() << std::endl;
-    }
-
-    void RepulsionCommand::printCommandDescription() const
-    {
-        std::cout << "Set peak repulsion strength." << std::endl;
-    }
-
-    std::vector<std::string> RepulsionCommand::getArguments() const
-    {
-        return { "repulsion strength" };
-    }
-
-    bool ParticleRadiusCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        float r;
-        if (!parser_.parseNonNegativeFloat(getArguments()[0], args[1], r))
-            return false;
-        options.setParticleRadius(r);
-        return true;
-    }
-
-    void ParticleRadiusCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "Particle display radius: " << options.getParticleRadius() << std::endl;
-    }
-
-    void ParticleRadiusCommand::printCommandDescription() const
-    {
-        std::cout << "Set radius of the particles as displayed to the screen. If set to 0, rendering will be much faster and particles will be rendered as 1px points." << std::endl;
-    }
-
-    std::vector<std::string> ParticleRadiusCommand::getArguments() const
-    {
-        return { "display radius" };
-    }
-
-    bool FrictionCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        float r;
-        if (!parser_.parseFloat(getArguments()[0], args[1], r, 0, 1))
-            return false;
-        options.setFriction(1 - r);
-        return true;
-    }
-
-    void FrictionCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "Particles lose " << (1 - options.getFriction()) * 100 << "% of their velocity per second (" << (1 - options.getFrictionMultiplierPerTick()) * 100 << "% each tick)." << std::endl;
-    }
-
-    void FrictionCommand::printCommandDescription() const
-    {
-        std::cout << "Set how fast particles lose their momentum." << std::endl;
-    }
-
-    std::vector<std::string> FrictionCommand::getArguments() const
-    {
-        return { "friction" };
-    }
-
-    bool WorldSizeCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        float maxRange = 0;
-        for (size_t s = 0; s < options.getSpeciesCount(); s++) {
-            for (auto&& r : options.getSpecies(s).attractionRange)
-            {
-                if (r > maxRange)
-                    maxRange = r;
-            }
-        }
-        float r;
-        if (!parser_.parseFloat(getArguments()[0], args[1], r, maxRange * MIN_WORLD_SIZE_RATIO, MAX_WORLD_SIZE))
-            return false;
-        options.setWorldSize(r);
-        return true;
-    }
-
-    void WorldSizeCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "The dimensions of the world are " << options.getWorldSize() << " by " << options.getWorldSize() << "." << std::endl;
-    }
-
-    void WorldSizeCommand::printCommandDescription() const
-    {
-        std::cout << "Set world size. It must be greater than three times the largest attraction range." << std::endl;
-    }
-
-    std::vector<std::string> WorldSizeCommand::getArguments() const
-    {
-        return { "size" };
-    }
-
-    bool SimSpeedCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        float r;
-        if (!parser_.parsePositiveFloat(getArguments()[0], args[1], r))
-            return false;
-        options.setSimulationSpeed(r);
-        return true;
-    }
-
-    void SimSpeedCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "Target simulation speed: " << options.getSimulationSpeed() << "x. Target ticks to simulate per second: " << 1 / options.getRealTimeStep() << "." << std::endl;
-    }
-
-    void SimSpeedCommand::printCommandDescription() const
-    {
-        std::cout << "Set simulation speed." << std::endl;
-    }
-
-    std::vector<std::string> SimSpeedCommand::getArguments() const
-    {
-        return { "speed multiplier" };
-    }
-
-    bool TimeStepCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        float r;
-        if (!parser_.parsePositiveFloat(getArguments()[0], args[1], r))
-            return false;
-        options.setTimeStep(r);
-        return true;
-    }
-
-    void TimeStepCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "Time step: " << options.getTimeStep() << " seconds. " << 1 / options.getTimeStep() << " ticks make 1 second of simulation." << std::endl;
-    }
-
-    void TimeStepCommand::printCommandDescription() const
-    {
-        std::cout << "Change simulation time step. Too long time steps make simulation unstable. Inverse of \"tps\"." << std::endl;
-    }
-
-    std::vector<std::string> TimeStepCommand::getArguments() const
-    {
-        return { "step in seconds" };
-    }
-
-    bool TPSCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        float r;
-        if (!parser_.parsePositiveFloat(getArguments()[0], args[1], r))
-            return false;
-        options.setTimeStep(1 / r);
-        return true;
-    }
-
-    void TPSCommand::printCurrentSettings(const Options& options) const
-    {
-        std::cout << "Time step: " << options.getTimeStep() << " seconds. " << 1 / options.getTimeStep() << " ticks make 1 second of simulation." << std::endl;
-    }
-
-    void TPSCommand::printCommandDescription() const
-    {
-        std::cout << "Change number of ticks per second of simulation. Too long time steps make simulation unstable. Inverse of \"ts\"." << std::endl;
-    }
-
-    std::vector<std::string> TPSCommand::getArguments() const
-    {
-        return { "TPS" };
-    }
-
-    bool ParticleCountCommand::run(Options& options, const std::vector<std::string>& args) const
-    {
-        size_t s, c;
-        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
-            return false;
-        if (!parser_.parseSizeT(getArguments()[1], args[2], c))
-            return false;
-        options.setParticleCount(s, c);
-        return true;
-    }
-
-    void ParticleCountCommand::printCurrentSettings(const Options& options) const
-    {
-        for (size_t i = 0; i < options.getSpeciesCount(); i++)
-        {
-            std::cout << "Particles of species " << i << ": " << options.getSpecies(i).count << std::endl;
-        }
-    }
-
-    void ParticleCountCommand::printCommandDescription() const
-    {
-        std::cout << "Change number of particles of a given species." << std::endl;
-    }
-
-    std::vector<std::string> ParticleCountCommand::getArguments() const
-    {
-        return { "species id", "particle count" };
-    }
-
-    void Command::Tabulate(std::vector<std::vector<float>>&& values) const
-    {
-        std::ostringstream s;
-        std::cout << std::setw(TABLE_CELL_WIDTH + HEADER_SPACING_WIDTH) << "other s.>";
-        for (size_t j = 0; j < values.size(); j++)
-        {
-            std::cout << std::setw(SPECIES_ID_WIDTH) << j << std::setw(TABLE_CELL_WIDTH + TABLE_CELL_SPACING - SPECIES_ID_WIDTH) << "";
-        }
-        std::cout << std::endl << " v species" << std::endl;
-        for (size_t i = 0; i < values.size(); i++)
-        {
-            std::cout << std::setw(SPECIES_ID_WIDTH) << i << std::setw(HEADER_SPACING_WIDTH) << "";
-            for (size_t j = 0; j < values[i].size(); j++)
-            {
-                s = {};
-                s << std::setprecision(TABLE_CELL_WIDTH - MIN_INTEGER_PART_WIDTH) << std::setw(TABLE_CELL_WIDTH) << values[i][j];
-                std::string str = s.str();
-                if (str.size() > TABLE_CELL_WIDTH) {
-                    s = {};
-                    s << std::setprecision(2 * TABLE_CELL_WIDTH - str.size() - MIN_INTEGER_PART_WIDTH) << std::setw(TABLE_CELL_WIDTH) << values[i][j];
-                    str = s.str();
-                }
-                std::cout << str << std::setw(TABLE_CELL_SPACING) << "";
-            }
-            std::cout << std::endl;
-        }
-    }
+#include "Command.h"
+#include "SweepRunner.h"
+#include "Simulation.h"
+#include "FrameExporter.h"
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <format>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+namespace ParticleLife {
+    constexpr float MAX_WORLD_SIZE = 1e9;
+    constexpr size_t MAX_CHUNKS = 100000;
+    /// @brief maximal ratio of attraction range to chunk size, limits the size of the chunk pattern
+    constexpr float MAX_CHUNK_RANGE = 128;
+    constexpr size_t MIN_WORLD_SIZE_RATIO = 3;
+    constexpr size_t MAX_THREADS = 1024;
+    constexpr size_t MAX_EXPORT_SIZE = 8192;
+
+    constexpr size_t TABLE_CELL_WIDTH = 7;
+    constexpr size_t TABLE_CELL_SPACING = 3;
+    constexpr size_t MIN_INTEGER_PART_WIDTH = 2;
+    constexpr size_t SPECIES_ID_WIDTH = 2;
+    constexpr size_t HEADER_SPACING_WIDTH = 5;
+    constexpr double MILLISECONDS_PER_SECOND = 1000.0;
+
+    bool FPSCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float fps;
+        if (!parser_.parseNonNegativeFloat(getArguments()[0], args[1], fps))
+            return false;
+        options.setFPS(fps);
+        return true;
+    }
+
+    void FPSCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "Target FPS: " << 1 / options.getFrameTime() << std::endl;
+    }
+
+    void FPSCommand::printCommandDescription() const
+    {
+        std::cout << "Set target frames per second." << std::endl;
+    }
+
+    std::vector<std::string> FPSCommand::getArguments() const
+    {
+        return { "FPS" };
+    }
+
+    bool ColorCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t s, r, g, b;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], r, 255))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[2], args[3], g, 255))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[3], args[4], b, 255))
+            return false;
+        options.setSpeciesColor(s, { (sf::Uint8)r,(sf::Uint8)g,(sf::Uint8)b });
+        return true;
+    }
+
+    void ColorCommand::printCurrentSettings(const Options& options) const
+    {
+        for (size_t i = 0; i < options.getSpeciesCount(); i++)
+        {
+            sf::Color c = options.getSpecies(i).color;
+            std::cout << "Color of species " << i << ": " << (size_t)c.r << " " << (size_t)c.g << " " << (size_t)c.b << std::endl;
+        }
+    }
+
+    void ColorCommand::printCommandDescription() const
+    {
+        std::cout << "Set the display color of a particle species." << std::endl;
+    }
+
+    std::vector<std::string> ColorCommand::getArguments() const
+    {
+        return { "species", "R", "G", "B" };
+    }
+
+    bool ControlCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float rate;
+#ifdef _WIN32
+        size_t port;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], port, UINT16_MAX))
+            return false;
+        std::string endpoint = port == 0 ? "" : std::to_string(port);
+#else
+        std::string endpoint = args[1] == "0" ? "" : args[1];
+#endif
+        if (!parser_.parseNonNegativeFloat(getArguments()[1], args[2], rate))
+            return false;
+        if (!server_.start(endpoint, rate)) {
+            std::cout << ERROR_TAG << "Cannot listen on \"" << endpoint << "\"." << std::endl;
+            return false;
+        }
+#ifdef _WIN32
+        if (!endpoint.empty())
+            std::cout << "Clients have to send " << server_.getToken() << " as their first line." << std::endl;
+#endif
+        return true;
+    }
+
+    void ControlCommand::printCurrentSettings(const Options& options) const
+    {
+        if (server_.getEndpoint().empty())
+            std::cout << "Control server is not running." << std::endl;
+        else {
+#ifdef _WIN32
+            std::cout << "Control server listens on 127.0.0.1:" << server_.getEndpoint() << " for clients sending " << server_.getToken() << " first";
+#else
+            std::cout << "Control server listens on socket \"" << server_.getEndpoint() << "\"";
+#endif
+            std::cout << " and sends " << server_.getTelemetryRate() << " telemetry lines per second." << std::endl;
+        }
+    }
+
+    void ControlCommand::printCommandDescription() const
+    {
+        std::cout << "Listen for scripts (0 to stop) on a Unix domain socket at the given path, which only the current user can connect to, or on Windows on a local TCP port, where a client's first line has to be the token printed by this command. Each other line a client sends is a batch of commands separated by \";\", answered by one JSON line with the success and output of each command. Clients also receive JSON lines with ticks per second, frames per second and time spent in each phase of the last tick at the given rate (0 for none)." << std::endl;
+    }
+
+    std::vector<std::string> ControlCommand::getArguments() const
+    {
+#ifdef _WIN32
+        return { "port", "telemetry rate" };
+#else
+        return { "socket path", "telemetry rate" };
+#endif
+    }
+
+    bool MetricsCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        std::ofstream out(args[1]);
+        if (!out) {
+            std::cout << ERROR_TAG << "Cannot open file \"" << args[1] << "\"." << std::endl;
+            return false;
+        }
+        metrics_.write(out, options.getRealTimeStep() * MILLISECONDS_PER_SECOND, options.getFrameTime() * MILLISECONDS_PER_SECOND);
+        return true;
+    }
+
+    void MetricsCommand::printCurrentSettings(const Options& options) const
+    {
+        metrics_.write(std::cout, options.getRealTimeStep() * MILLISECONDS_PER_SECOND, options.getFrameTime() * MILLISECONDS_PER_SECOND);
+    }
+
+    void MetricsCommand::printCommandDescription() const
+    {
+        std::cout << "Write count, mean, median, 90th and 99th percentile and maximum of the time spent by each tick and frame and of the time between them since the start, and the number of ticks and frames skipped because the program fell behind, into a tab separated file." << std::endl;
+    }
+
+    std::vector<std::string> MetricsCommand::getArguments() const
+    {
+        return { "output file" };
+    }
+
+    bool LogCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        if (!log_.save(args[1], simulation_.getTickCount())) {
+            std::cout << ERROR_TAG << "Cannot open file \"" << args[1] << "\"." << std::endl;
+            return false;
+        }
+        std::cout << log_.getEntries().size() << " commands over " << simulation_.getTickCount() << " ticks written to \"" << args[1] << "\". State checksum: " << std::hex << simulation_.getStateChecksum() << std::dec << "." << std::endl;
+        return true;
+    }
+
+    void LogCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << log_.getEntries().size() << " commands logged over " << simulation_.getTickCount() << " ticks since the start with seed " << options.getSeed() << "." << std::endl;
+    }
+
+    void LogCommand::printCommandDescription() const
+    {
+        std::cout << "Write the seed and all commands changing the simulation since the start, each with the tick at which it took effect, into a file for replay." << std::endl;
+    }
+
+    std::vector<std::string> LogCommand::getArguments() const
+    {
+        return { "output file" };
+    }
+
+    bool ReplayCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        CommandLog log(0);
+        if (!log.load(args[1])) {
+            std::cout << ERROR_TAG << "Cannot read command log \"" << args[1] << "\"." << std::endl;
+            return false;
+        }
+        Options replayed(log.getSeed());
+        Simulation simulation(replayed);
+        simulation.init();
+        auto start = std::chrono::steady_clock::now();
+        for (auto&& entry : log.getEntries()) {
+            while (simulation.getTickCount() < entry.tick) {
+                simulation.tick();
+            }
+            auto command = commands_.find(entry.args[0]);
+            if (command == commands_.end() || !command->second->isLogged() || command->second->argCount() != entry.args.size() - 1 || !command->second->run(replayed, entry.args)) {
+                std::cout << ERROR_TAG << "Cannot replay command \"" << entry.args[0] << "\" at tick " << entry.tick << "." << std::endl;
+                return false;
+            }
+        }
+        while (simulation.getTickCount() < log.getEndTick()) {
+            simulation.tick();
+        }
+        std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+        std::cout << "Replayed " << log.getEntries().size() << " commands over " << simulation.getTickCount() << " ticks in " << duration.count() << " ms";
+        if (simulation.getTickCount() > 0)
+            std::cout << " (" << duration.count() / simulation.getTickCount() << " ms per tick)";
+        std::cout << ". State checksum: " << std::hex << simulation.getStateChecksum() << std::dec << "." << std::endl;
+        return true;
+    }
+
+    void ReplayCommand::printCommandDescription() const
+    {
+        std::cout << "Rerun a session written by \"log\" from its seed as fast as possible without rendering, applying each command at its tick, and print how long it took and a checksum of the final state." << std::endl;
+    }
+
+    std::vector<std::string> ReplayCommand::getArguments() const
+    {
+        return { "log file" };
+    }
+
+    bool HelpCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        for (auto&& e : commands_) {
+            std::cout << " - " << e.first << ": ";
+            e.second->printCommandDescription();
+        }
+        return true;
+    }
+
+
+    void HelpCommand::printCommandDescription() const
+    {
+        std::cout << "Prints this table." << std::endl;
+    }
+
+
+    bool ExitCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        exit(0);
+    }
+
+
+    void ExitCommand::printCommandDescription() const
+    {
+        std::cout << "Exit this application." << std::endl;
+    }
+
+
+    bool StepCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        options.paused = true;
+        options.step = true;
+        return true;
+    }
+
+
+    void StepCommand::printCommandDescription() const
+    {
+        std::cout << "Run a single tick of simulation." << std::endl;
+    }
+
+
+    bool SweepCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t runs, ticks;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], runs))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], ticks))
+            return false;
+        if (!checkChunkRange(options, Options::MAX_RANDOM_ATTRACTION_RANGE))
+            return false;
+        std::ofstream out(args[3]);
+        if (!out) {
+            std::cout << ERROR_TAG << "Cannot open file \"" << args[3] << "\"." << std::endl;
+            return false;
+        }
+        SweepRunner runner(ticks);
+        // the seeds are listed in the results, so they needn't come from the options' random engine, which stays reproducible by the command log
+        runner.addRandomSample(options, runs, (uint32_t)std::random_device()());
+        runner.run();
+        runner.writeResults(out);
+        std::cout << "Results of " << runs << " runs written to \"" << args[3] << "\"." << std::endl;
+        return true;
+    }
+
+    void SweepCommand::printCommandDescription() const
+    {
+        std::cout << "Run many headless simulations with random attraction strengths and ranges at once and write a table of their structure metrics into a file." << std::endl;
+    }
+
+    std::vector<std::string> SweepCommand::getArguments() const
+    {
+        return { "runs", "ticks", "output file" };
+    }
+
+    bool AttractionSweepCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t s, os, steps, ticks;
+        float a;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], os, options.getSpeciesCount() - 1))
+            return false;
+        if (!parser_.parseNonNegativeFloat(getArguments()[2], args[3], a))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[3], args[4], steps))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[4], args[5], ticks))
+            return false;
+        std::ofstream out(args[6]);
+        if (!out) {
+            std::cout << ERROR_TAG << "Cannot open file \"" << args[6] << "\"." << std::endl;
+            return false;
+        }
+        SweepRunner runner(ticks);
+        runner.addAttractionGrid(options, s, os, a, steps);
+        runner.run();
+        runner.writeResults(out);
+        std::cout << "Results of " << steps << " runs written to \"" << args[6] << "\"." << std::endl;
+        return true;
+    }
+
+    void AttractionSweepCommand::printCommandDescription() const
+    {
+        std::cout << "Run many headless simulations with attraction strength of given species to the other species spread evenly between negative and positive maximum at once and write a table of their structure metrics into a file." << std::endl;
+    }
+
+    std::vector<std::string> AttractionSweepCommand::getArguments() const
+    {
+        return { "species id", "other species id", "max attraction strength", "steps", "ticks", "output file" };
+    }
+
+    bool ExportCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t ticks, interval, size;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], ticks, 1, SIZE_MAX))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], interval, 1, SIZE_MAX))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[2], args[3], size, 1, MAX_EXPORT_SIZE))
+            return false;
+        // half of the threads encode, the other half simulate
+        size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        size_t encodingThreads = std::max((size_t)1, hardwareThreads / 2);
+        FrameExporter exporter(args[4], (unsigned int)size, encodingThreads);
+        if (!exporter.isOpen()) {
+            std::cout << ERROR_TAG << "Cannot open file \"" << args[4] << "\"." << std::endl;
+            return false;
+        }
+        // the exported simulation mustn't write into the observables file or shared memory of the interactive one
+        Options exported = options;
+        exported.setObservables(0, "");
+        exported.setSharedFrames(0, "");
+        exported.setThreads(std::max((size_t)1, hardwareThreads - encodingThreads), exported.getThreadPlacement());
+        Simulation simulation(exported);
+        simulation.init();
+        for (size_t i = 0; i < ticks; i++)
+        {
+            if (i % interval == 0)
+                exporter.submit(FrameSnapshot::capture(simulation.getParticles(), exported));
+            simulation.tick();
+        }
+        exporter.finish();
+        std::cout << exporter.getWrittenCount() << " frames written to \"" << args[4] << "\"." << std::endl;
+        if (exporter.getFailedCount() > 0)
+            std::cout << ERROR_TAG << exporter.getFailedCount() << " frames failed to be saved." << std::endl;
+        return true;
+    }
+
+    void ExportCommand::printCommandDescription() const
+    {
+        std::cout << "Run a headless simulation and save every n-th tick as an image, drawn the same way as in the window. Frames are saved as numbered PNG files, or appended as raw RGBA video into one file if its name ends with \".rgba\"." << std::endl;
+    }
+
+    std::vector<std::string> ExportCommand::getArguments() const
+    {
+        return { "ticks", "frame interval", "image size", "output file" };
+    }
+
+    double BenchmarkCommand::measure(const Options& options, size_t ticks, float& forceTableError) const
+    {
+        Simulation simulation(options);
+        simulation.init();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ticks; i++)
+        {
+            simulation.tick();
+        }
+        std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+        forceTableError = simulation.getForceTableError();
+        return duration.count() / ticks;
+    }
+
+    bool BenchmarkCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t ticks;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], ticks, 1, SIZE_MAX))
+            return false;
+        Options reordered = options;
+        reordered.setReordering(true);
+        reordered.setTabulatedForces(false);
+        reordered.setQuiescence(0, options.getQuiescenceTicks(), options.getQuiescenceRefreshInterval());
+        reordered.setObservables(0, "");
+        reordered.setSharedFrames(0, "");
+        Options unordered = reordered;
+        unordered.setReordering(false);
+        Options tabulated = reordered;
+        tabulated.setTabulatedForces(true);
+        float error;
+        std::cout << "Particles reordered by chunks: " << measure(reordered, ticks, error) << " ms per tick" << std::endl;
+        std::cout << "Particles in spawn order: " << measure(unordered, ticks, error) << " ms per tick" << std::endl;
+        std::cout << "Reordered, tabulated forces: " << measure(tabulated, ticks, error) << " ms per tick, force error at most " << error << " (" << error / options.getRepulsion() * 100 << "% of peak repulsion)" << std::endl;
+        if (options.getQuiescenceDistance() > 0) {
+            Options quiet = reordered;
+            quiet.setQuiescence(options.getQuiescenceDistance(), options.getQuiescenceTicks(), options.getQuiescenceRefreshInterval());
+            std::cout << "Reordered, forces of settled chunks reused: " << measure(quiet, ticks, error) << " ms per tick" << std::endl;
+        }
+        return true;
+    }
+
+    void BenchmarkCommand::printCommandDescription() const
+    {
+        std::cout << "Measure how long a tick takes with current settings, with and without reordering particles in memory by chunks, with exact and tabulated forces, and with forces of settled chunks reused if \"quiet\" is on." << std::endl;
+    }
+
+    std::vector<std::string> BenchmarkCommand::getArguments() const
+    {
+        return { "ticks" };
+    }
+
+    bool ThreadsCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t count, placement;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], count, MAX_THREADS))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], placement, (size_t)ThreadPlacement::PinnedHugePages))
+            return false;
+        options.setThreads(count, (ThreadPlacement)placement);
+        return true;
+    }
+
+    void ThreadsCommand::printCurrentSettings(const Options& options) const
+    {
+        if (options.getThreadCount() == 0)
+            std::cout << "Threads: one per hardware thread (" << std::thread::hardware_concurrency() << ")";
+        else
+            std::cout << "Threads: " << options.getThreadCount();
+        switch (options.getThreadPlacement())
+        {
+        case ThreadPlacement::Free:
+            std::cout << ", not pinned" << std::endl;
+            break;
+        case ThreadPlacement::Pinned:
+            std::cout << ", pinned to cores" << std::endl;
+            break;
+        case ThreadPlacement::PinnedHugePages:
+            std::cout << ", pinned to cores, particles in huge pages" << std::endl;
+            break;
+        }
+    }
+
+    void ThreadsCommand::printCommandDescription() const
+    {
+        std::cout << "Set the number of simulation threads (0 for one per hardware thread) and their placement: 0 - scheduled freely, 1 - each pinned to its own core, 2 - pinned and particles stored in huge memory pages (Linux only). Pinned threads keep the particles they update in memory close to their core." << std::endl;
+    }
+
+    std::vector<std::string> ThreadsCommand::getArguments() const
+    {
+        return { "thread count", "placement" };
+    }
+
+    bool ObservablesCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t interval;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], interval))
+            return false;
+        if (interval > 0 && args[2] != options.getObservablesFile() && !std::ofstream(args[2])) {
+            std::cout << ERROR_TAG << "Cannot open file \"" << args[2] << "\"." << std::endl;
+            return false;
+        }
+        options.setObservables(interval, args[2]);
+        return true;
+    }
+
+    void ObservablesCommand::printCurrentSettings(const Options& options) const
+    {
+        if (options.getObservablesInterval() == 0)
+            std::cout << "Observables are not measured." << std::endl;
+        else
+            std::cout << "Observables are measured every " << options.getObservablesInterval() << " ticks and written to \"" << options.getObservablesFile() << "\"." << std::endl;
+    }
+
+    void ObservablesCommand::printCommandDescription() const
+    {
+        std::cout << "Measure kinetic energy of each species, radial distribution of each species pair and the fraction of pairs close enough to repel each other every given number of ticks (0 to stop) while computing forces, and write them into a file in the background. The file is CSV, or binary records of 64 bit values if its name ends with \".bin\"." << std::endl;
+    }
+
+    std::vector<std::string> ObservablesCommand::getArguments() const
+    {
+        return { "interval", "output file" };
+    }
+
+    bool SharedFramesCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t interval;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], interval))
+            return false;
+        if (interval > 0 && !FramePublisher::isValidName(args[2])) {
+            std::cout << ERROR_TAG << "Invalid shared memory name \"" << args[2] << "\", use only letters, digits, '_', '-' and '.'." << std::endl;
+            return false;
+        }
+        options.setSharedFrames(interval, args[2]);
+        return true;
+    }
+
+    void SharedFramesCommand::printCurrentSettings(const Options& options) const
+    {
+        if (options.getSharedFramesInterval() == 0)
+            std::cout << "Frames are not published into shared memory." << std::endl;
+        else
+            std::cout << "Frames are published every " << options.getSharedFramesInterval() << " ticks into shared memory \"" << options.getSharedFramesName() << "\"." << std::endl;
+    }
+
+    void SharedFramesCommand::printCommandDescription() const
+    {
+        std::cout << "Publish positions and species of all particles every given number of ticks (0 to stop) into a named shared memory region (\"/dev/shm/<name>\" on Linux), which other processes can map to view the simulation live. The region starts with a header followed by a ring of frames, each guarded by a sequence number that is odd while the frame is written, the layout is described in FramePublisher.h." << std::endl;
+    }
+
+    std::vector<std::string> SharedFramesCommand::getArguments() const
+    {
+        return { "interval", "name" };
+    }
+
+    bool ClustersCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float distance;
+        size_t interval;
+        if (!parser_.parseFloat(getArguments()[0], args[1], distance, 0, getMaxAttractionRange(options)))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], interval))
+            return false;
+        options.setClusterAnalysis(distance, interval);
+        return true;
+    }
+
+    void ClustersCommand::printCurrentSettings(const Options& options) const
+    {
+        if (options.getClusterInterval() == 0)
+            std::cout << "Cluster analysis is off." << std::endl;
+        else
+            std::cout << "Particles closer than " << options.getClusterLinkingDistance() << " to each other belong to the same cluster, clusters are found every " << options.getClusterInterval() << " ticks." << std::endl;
+        const std::optional<ClusterReport>& report = simulation_.getClusterReport();
+        if (!report)
+            return;
+        std::cout << "Last analysis at " << report->time << " s found " << report->clusterCount << " clusters of " << report->particleCount << " particles (linking distance " << report->linkingDistance << ")." << std::endl;
+        std::cout << "Number of clusters by size:" << std::endl;
+        for (size_t i = 0; i < report->sizeHistogram.size(); i++)
+        {
+            size_t minSize = (size_t)1 << i;
+            size_t maxSize = ((size_t)2 << i) - 1;
+            if (minSize == maxSize)
+                std::cout << "  " << minSize << ": " << report->sizeHistogram[i] << std::endl;
+            else
+                std::cout << "  " << minSize << "-" << maxSize << ": " << report->sizeHistogram[i] << std::endl;
+        }
+        std::cout << "Largest clusters (size: particles of each species):" << std::endl;
+        for (auto&& cluster : report->largest) {
+            std::cout << "  " << cluster.size << ":";
+            for (auto&& count : cluster.speciesCounts) {
+                std::cout << " " << count;
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    void ClustersCommand::printCommandDescription() const
+    {
+        std::cout << "Find clusters - groups of particles connected by chains of particles closer than the linking distance - every given number of ticks (0 to stop). The linking distance can be at most the largest attraction range. The search is spread over the interval, each tick doing its share, so the clusters are reported one interval after the positions they were found in, and an interval of 1 does the whole search every tick. Without arguments, reports the last found clusters: their count, sizes and species of the largest ones." << std::endl;
+    }
+
+    std::vector<std::string> ClustersCommand::getArguments() const
+    {
+        return { "linking distance", "interval" };
+    }
+
+    bool PauseCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        options.paused = !options.paused;
+        return true;
+    }
+
+    void PauseCommand::printCommandDescription() const
+    {
+        std::cout << "Pause or unpause the simulation." << std::endl;
+    }
+
+
+    bool RepulsionRangeCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t s, os;
+        float r;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], os, options.getSpeciesCount() - 1))
+            return false;
+        if (!parser_.parseFloat(getArguments()[2], args[3], r, 0, options.getSpecies(s).attractionRange[os]))
+            return false;
+        options.setSpeciesRepulsionRange(s, os, r);
+        return true;
+    }
+
+    void RepulsionRangeCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "Repulsion range:" << std::endl;
+        std::vector<std::vector<float>> values;
+        for (size_t i = 0; i < options.getSpeciesCount(); i++)
+        {
+            values.push_back(options.getSpecies(i).repulsionRange);
+        }
+        Tabulate(std::move(values));
+    }
+
+    void RepulsionRangeCommand::printCommandDescription() const
+    {
+        std::cout << "Set the distance at which particles of given species start being repelled from particles of the other species. Must be less than the corresponding attraction range." << std::endl;
+    }
+
+    std::vector<std::string> RepulsionRangeCommand::getArguments() const
+    {
+        return { "species id", "other species id", "repulsion range" };
+    }
+
+    bool AttractionRangeCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t s, os;
+        float r;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], os, options.getSpeciesCount() - 1))
+            return false;
+        if (!parser_.parseFloat(getArguments()[2], args[3], r, options.getSpecies(s).repulsionRange[os], options.getWorldSize() / MIN_WORLD_SIZE_RATIO))
+            return false;
+        if (!checkChunkRange(options, r))
+            return false;
+        options.setSpeciesAttractionRange(s, os, r);
+        return true;
+    }
+
+    void AttractionRangeCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "Attraction range:" << std::endl;
+        std::vector<std::vector<float>> values;
+        for (size_t i = 0; i < options.getSpeciesCount(); i++)
+        {
+            values.push_back(options.getSpecies(i).attractionRange);
+        }
+        Tabulate(std::move(values));
+    }
+
+    void AttractionRangeCommand::printCommandDescription() const
+    {
+        std::cout << "Set the distance at which particles of given species start being attracted to particles of the other species. Must be more than the corresponding repulsion range and less than third of world size." << std::endl;
+    }
+
+    std::vector<std::string> AttractionRangeCommand::getArguments() const
+    {
+        return { "species id", "other species id", "attraction range" };
+    }
+
+    bool AttractionCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t s, os;
+        float r;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], os, options.getSpeciesCount() - 1))
+            return false;
+        if (!parser_.parseFloat(getArguments()[2], args[3], r))
+            return false;
+        options.setSpeciesAttraction(s, os, r);
+        return true;
+    }
+
+    void AttractionCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "Attraction strength:" << std::endl;
+        std::vector<std::vector<float>> values;
+        for (size_t i = 0; i < options.getSpeciesCount(); i++)
+        {
+            values.push_back(options.getSpecies(i).attraction);
+        }
+        Tabulate(std::move(values));
+    }
+
+    void AttractionCommand::printCommandDescription() const
+    {
+        std::cout << "Set the peak strength of attraction of particles of given species to particles of the other species. Can be negative, then the particles are repelled instead." << std::endl;
+    }
+
+    std::vector<std::string> AttractionCommand::getArguments() const
+    {
+        return { "species id", "other species id", "attraction strength" };
+    }
+
+    bool AddSpeciesCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t c;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], c))
+            return false;
+        if (!checkChunkRange(options, Options::MAX_RANDOM_ATTRACTION_RANGE))
+            return false;
+        options.addRandomSpecies(c);
+        return true;
+    }
+
+    void AddSpeciesCommand::printCommandDescription() const
+    {
+        std::cout << "Add a new particle species with given particle count." << std::endl;
+    }
+
+    std::vector<std::string> AddSpeciesCommand::getArguments() const
+    {
+        return { "count" };
+    }
+
+    bool ChunkCountCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t c;
+        size_t maxChunks = std::min(MAX_CHUNKS, (size_t)(options.getWorldSize() * MAX_CHUNK_RANGE / getMaxAttractionRange(options)));
+        if (!parser_.parseSizeT(getArguments()[0], args[1], c, MIN_WORLD_SIZE_RATIO, maxChunks))
+            return false;
+        options.setChunkCount(c);
+        return true;
+    }
+
+    void ChunkCountCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "The world is split into " << options.getChunkCount() << " by " << options.getChunkCount() << " chunks. Their size is " << options.getChunkSize() << "x" << options.getChunkSize() << "." << std::endl;
+    }
+
+    void ChunkCountCommand::printCommandDescription() const
+    {
+        std::cout << "The world will be split along each axis into a given amount of chunks. This setting won't affect the simulation, but will affect computation time." << std::endl;
+    }
+
+    std::vector<std::string> ChunkCountCommand::getArguments() const
+    {
+        return { "amount" };
+    }
+
+    bool RepulsionCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float r;
+        if (!parser_.parsePositiveFloat(getArguments()[0], args[1], r))
+            return false;
+        options.setRepulsion(r);
+        return true;
+    }
+
+    void RepulsionCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "Peak repulsion strength: " << options.getRepulsion() << std::endl;
+    }
+
+    void RepulsionCommand::printCommandDescription() const
+    {
+        std::cout << "Set peak repulsion strength." << std::endl;
+    }
+
+    std::vector<std::string> RepulsionCommand::getArguments() const
+    {
+        return { "repulsion strength" };
+    }
+
+    bool ForceLawCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t law;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], law, (size_t)ForceLaw::LennardJones))
+            return false;
+        options.setForceLaw((ForceLaw)law);
+        return true;
+    }
+
+    void ForceLawCommand::printCurrentSettings(const Options& options) const
+    {
+        switch (options.getForceLaw())
+        {
+        case ForceLaw::PiecewiseLinear:
+            std::cout << "Force law: piecewise linear" << std::endl;
+            break;
+        case ForceLaw::SmoothCubic:
+            std::cout << "Force law: smooth cubic" << std::endl;
+            break;
+        case ForceLaw::LennardJones:
+            std::cout << "Force law: Lennard-Jones" << std::endl;
+            break;
+        }
+    }
+
+    void ForceLawCommand::printCommandDescription() const
+    {
+        std::cout << "Set how the force between particles depends on their distance: 0 - piecewise linear, attraction rises linearly to its peak halfway through the attraction range and falls back, 1 - smooth cubic, the same attraction peak without kinks, 2 - Lennard-Jones, steep repulsion and an attraction well peaking close to the repulsion range. All use the same strengths and ranges." << std::endl;
+    }
+
+    std::vector<std::string> ForceLawCommand::getArguments() const
+    {
+        return { "force law" };
+    }
+
+    bool TabulatedForceCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t tabulated;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], tabulated, 1))
+            return false;
+        options.setTabulatedForces(tabulated == 1);
+        return true;
+    }
+
+    void TabulatedForceCommand::printCurrentSettings(const Options& options) const
+    {
+        if (options.isTabulatedForces())
+            std::cout << "Forces are interpolated from tables of " << TabulatedForce::TABLE_SIZE << " intervals per species pair." << std::endl;
+        else
+            std::cout << "Forces are computed exactly." << std::endl;
+    }
+
+    void TabulatedForceCommand::printCommandDescription() const
+    {
+        std::cout << "Set whether forces are computed exactly (0) or interpolated from a table of each species pair (1), which is faster but less precise. Closer than 1/32 of the attraction range, the tabulated force fades out linearly instead of reaching peak repulsion. Use \"bench\" to see the largest error beyond that." << std::endl;
+    }
+
+    std::vector<std::string> TabulatedForceCommand::getArguments() const
+    {
+        return { "tabulated" };
+    }
+
+    bool QuiescenceCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float distance;
+        size_t ticks, refreshInterval;
+        if (!parser_.parseNonNegativeFloat(getArguments()[0], args[1], distance))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], ticks, 1, SIZE_MAX))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[2], args[3], refreshInterval, 1, SIZE_MAX))
+            return false;
+        options.setQuiescence(distance, ticks, refreshInterval);
+        return true;
+    }
+
+    void QuiescenceCommand::printCurrentSettings(const Options& options) const
+    {
+        if (options.getQuiescenceDistance() == 0)
+            std::cout << "All forces are computed every tick." << std::endl;
+        else
+            std::cout << "Forces of chunks whose particles, and the particles of all chunks within their reach, stayed within " << options.getQuiescenceDistance() << " of where they settled for " << options.getQuiescenceTicks() << " ticks are reused, all forces are recomputed every " << options.getQuiescenceRefreshInterval() << " ticks." << std::endl;
+        const std::optional<QuiescenceReport>& report = simulation_.getQuiescenceReport();
+        if (!report || options.getQuiescenceDistance() == 0)
+            return;
+        std::cout << "Forces reused for " << report->lastReused * 100 << "% of particles in the last tick, " << report->totalReused * 100 << "% of particle updates since forces last changed." << std::endl;
+        std::cout << "Reused forces were computed with all particles within reach at most " << report->maxDisplacement << " from their current positions." << std::endl;
+        if (report->refreshTime < 0)
+            return;
+        std::cout << "Last refresh at " << report->refreshTime << " s compared " << report->sampledParticles << " forces which could have been reused with recomputed ones: error at most " << report->maxError << ", mean error " << report->meanError << " (";
+        std::cout << (report->meanAcceleration == 0 ? 0 : report->meanError / report->meanAcceleration * 100) << "% of the mean force " << report->meanAcceleration << ")." << std::endl;
+    }
+
+    void QuiescenceCommand::printCommandDescription() const
+    {
+        std::cout << "Reuse forces of chunks where all particles, and all particles of chunks within their reach, have stayed within a given distance (0 to compute all forces every tick) of where they settled for a given number of ticks, and recompute all forces every given number of ticks. Saves most of the work once structures settle, at the cost of approximate forces. Without arguments, also reports how many forces were reused and how far they were off at the last recomputation of all forces." << std::endl;
+    }
+
+    std::vector<std::string> QuiescenceCommand::getArguments() const
+    {
+        return { "distance", "ticks", "refresh interval" };
+    }
+
+    bool ParticleRadiusCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float r;
+        if (!parser_.parseNonNegativeFloat(getArguments()[0], args[1], r))
+            return false;
+        options.setParticleRadius(r);
+        return true;
+    }
+
+    void ParticleRadiusCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "Particle display radius: " << options.getParticleRadius() << std::endl;
+    }
+
+    void ParticleRadiusCommand::printCommandDescription() const
+    {
+        std::cout << "Set radius of the particles as displayed to the screen. If set to 0, rendering will be much faster and particles will be rendered as 1px points." << std::endl;
+    }
+
+    std::vector<std::string> ParticleRadiusCommand::getArguments() const
+    {
+        return { "display radius" };
+    }
+
+    bool DisplayModeCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t mode;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], mode, (size_t)DisplayMode::Density))
+            return false;
+        options.setDisplayMode((DisplayMode)mode);
+        return true;
+    }
+
+    void DisplayModeCommand::printCurrentSettings(const Options& options) const
+    {
+        if (options.getDisplayMode() == DisplayMode::Density)
+            std::cout << "Particles are displayed as a density heat map." << std::endl;
+        else
+            std::cout << "Particles are displayed one by one." << std::endl;
+    }
+
+    void DisplayModeCommand::printCommandDescription() const
+    {
+        std::cout << "Set how particles are displayed: 0 - each particle is drawn separately, 1 - density heat map, each pixel is colored by the species in it and brighter the more particles it contains. The heat map takes the same time regardless of particle count, so it is much faster for millions of particles." << std::endl;
+    }
+
+    std::vector<std::string> DisplayModeCommand::getArguments() const
+    {
+        return { "mode" };
+    }
+
+    bool ViewCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float zoom, x, y;
+        if (!parser_.parseFloat(getArguments()[0], args[1], zoom, 1, Options::MAX_VIEW_ZOOM))
+            return false;
+        if (!parser_.parseFloat(getArguments()[1], args[2], x, 0, options.getWorldSize()))
+            return false;
+        if (!parser_.parseFloat(getArguments()[2], args[3], y, 0, options.getWorldSize()))
+            return false;
+        options.setView(zoom, sf::Vector2f(x, y));
+        return true;
+    }
+
+    void ViewCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "View zoom: " << options.getViewZoom() << ", center: " << options.getViewCenter().x << " " << options.getViewCenter().y << std::endl;
+    }
+
+    void ViewCommand::printCommandDescription() const
+    {
+        std::cout << "Set magnification of the view (1 shows the whole world) and the world coordinates of its center. The view wraps around the edges of the world. It can also be zoomed by the mouse wheel and moved by dragging with the left mouse button. Only chunks within the view are drawn." << std::endl;
+    }
+
+    std::vector<std::string> ViewCommand::getArguments() const
+    {
+        return { "zoom", "center x", "center y" };
+    }
+
+    bool SmoothMotionCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t smooth;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], smooth, 1))
+            return false;
+        options.setSmoothMotion(smooth == 1);
+        return true;
+    }
+
+    void SmoothMotionCommand::printCurrentSettings(const Options& options) const
+    {
+        if (options.isSmoothMotion())
+            std::cout << "Particles are drawn where they move to between ticks." << std::endl;
+        else
+            std::cout << "Particles are drawn where the last tick left them." << std::endl;
+    }
+
+    void SmoothMotionCommand::printCommandDescription() const
+    {
+        std::cout << "Set whether particles are drawn where the last tick left them (0) or moved along their velocity by the time passed since that tick (1), so that motion looks smooth even with fewer ticks than frames per second." << std::endl;
+    }
+
+    std::vector<std::string> SmoothMotionCommand::getArguments() const
+    {
+        return { "smooth" };
+    }
+
+    bool FrictionCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float r;
+        if (!parser_.parseFloat(getArguments()[0], args[1], r, 0, 1))
+            return false;
+        options.setFriction(1 - r);
+        return true;
+    }
+
+    void FrictionCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "Particles lose " << (1 - options.getFriction()) * 100 << "% of their velocity per second (" << (1 - options.getFrictionMultiplierPerTick()) * 100 << "% each tick)." << std::endl;
+    }
+
+    void FrictionCommand::printCommandDescription() const
+    {
+        std::cout << "Set how fast particles lose their momentum." << std::endl;
+    }
+
+    std::vector<std::string> FrictionCommand::getArguments() const
+    {
+        return { "friction" };
+    }
+
+    bool WorldSizeCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float maxRange = getMaxAttractionRange(options);
+        float minSize = std::max(maxRange * MIN_WORLD_SIZE_RATIO, maxRange * options.getChunkCount() / MAX_CHUNK_RANGE);
+        float r;
+        if (!parser_.parseFloat(getArguments()[0], args[1], r, minSize, MAX_WORLD_SIZE))
+            return false;
+        options.setWorldSize(r);
+        return true;
+    }
+
+    void WorldSizeCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "The dimensions of the world are " << options.getWorldSize() << " by " << options.getWorldSize() << "." << std::endl;
+    }
+
+    void WorldSizeCommand::printCommandDescription() const
+    {
+        std::cout << "Set world size. It must be greater than three times the largest attraction range." << std::endl;
+    }
+
+    std::vector<std::string> WorldSizeCommand::getArguments() const
+    {
+        return { "size" };
+    }
+
+    bool SimSpeedCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float r;
+        if (!parser_.parsePositiveFloat(getArguments()[0], args[1], r))
+            return false;
+        options.setSimulationSpeed(r);
+        return true;
+    }
+
+    void SimSpeedCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "Target simulation speed: " << options.getSimulationSpeed() << "x. Target ticks to simulate per second: " << 1 / options.getRealTimeStep() << "." << std::endl;
+    }
+
+    void SimSpeedCommand::printCommandDescription() const
+    {
+        std::cout << "Set simulation speed." << std::endl;
+    }
+
+    std::vector<std::string> SimSpeedCommand::getArguments() const
+    {
+        return { "speed multiplier" };
+    }
+
+    bool TimeStepCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float r;
+        if (!parser_.parsePositiveFloat(getArguments()[0], args[1], r))
+            return false;
+        options.setTimeStep(r);
+        return true;
+    }
+
+    void TimeStepCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "Time step: " << options.getTimeStep() << " seconds. " << 1 / options.getTimeStep() << " ticks make 1 second of simulation." << std::endl;
+    }
+
+    void TimeStepCommand::printCommandDescription() const
+    {
+        std::cout << "Change simulation time step. Too long time steps make simulation unstable. Inverse of \"tps\"." << std::endl;
+    }
+
+    std::vector<std::string> TimeStepCommand::getArguments() const
+    {
+        return { "step in seconds" };
+    }
+
+    bool TPSCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        float r;
+        if (!parser_.parsePositiveFloat(getArguments()[0], args[1], r))
+            return false;
+        options.setTimeStep(1 / r);
+        return true;
+    }
+
+    void TPSCommand::printCurrentSettings(const Options& options) const
+    {
+        std::cout << "Time step: " << options.getTimeStep() << " seconds. " << 1 / options.getTimeStep() << " ticks make 1 second of simulation." << std::endl;
+    }
+
+    void TPSCommand::printCommandDescription() const
+    {
+        std::cout << "Change number of ticks per second of simulation. Too long time steps make simulation unstable. Inverse of \"ts\"." << std::endl;
+    }
+
+    std::vector<std::string> TPSCommand::getArguments() const
+    {
+        return { "TPS" };
+    }
+
+    bool ParticleCountCommand::run(Options& options, const std::vector<std::string>& args) const
+    {
+        size_t s, c;
+        if (!parser_.parseSizeT(getArguments()[0], args[1], s, options.getSpeciesCount() - 1))
+            return false;
+        if (!parser_.parseSizeT(getArguments()[1], args[2], c))
+            return false;
+        options.setParticleCount(s, c);
+        return true;
+    }
+
+    void ParticleCountCommand::printCurrentSettings(const Options& options) const
+    {
+        for (size_t i = 0; i < options.getSpeciesCount(); i++)
+        {
+            std::cout << "Particles of species " << i << ": " << options.getSpecies(i).count << std::endl;
+        }
+    }
+
+    void ParticleCountCommand::printCommandDescription() const
+    {
+        std::cout << "Change number of particles of a given species." << std::endl;
+    }
+
+    std::vector<std::string> ParticleCountCommand::getArguments() const
+    {
+        return { "species id", "particle count" };
+    }
+
+    float Command::getMaxAttractionRange(const Options& options) const
+    {
+        float maxRange = 0;
+        for (size_t s = 0; s < options.getSpeciesCount(); s++) {
+            for (auto&& r : options.getSpecies(s).attractionRange)
+            {
+                if (r > maxRange)
+                    maxRange = r;
+            }
+        }
+        return maxRange;
+    }
+
+    bool Command::checkChunkRange(const Options& options, float range) const
+    {
+        if (range / options.getChunkSize() > MAX_CHUNK_RANGE) {
+            std::cout << ERROR_TAG << "Attraction range " << range << " would span more than " << MAX_CHUNK_RANGE << " chunks, lower the chunk count first." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void Command::Tabulate(std::vector<std::vector<float>>&& values) const
+    {
+        std::ostringstream s;
+        std::cout << std::setw(TABLE_CELL_WIDTH + HEADER_SPACING_WIDTH) << "other s.>";
+        for (size_t j = 0; j < values.size(); j++)
+        {
+            std::cout << std::setw(SPECIES_ID_WIDTH) << j << std::setw(TABLE_CELL_WIDTH + TABLE_CELL_SPACING - SPECIES_ID_WIDTH) << "";
+        }
+        std::cout << std::endl << " v species" << std::endl;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            std::cout << std::setw(SPECIES_ID_WIDTH) << i << std::setw(HEADER_SPACING_WIDTH) << "";
+            for (size_t j = 0; j < values[i].size(); j++)
+            {
+                s = {};
+                s << std::setprecision(TABLE_CELL_WIDTH - MIN_INTEGER_PART_WIDTH) << std::setw(TABLE_CELL_WIDTH) << values[i][j];
+                std::string str = s.str();
+                if (str.size() > TABLE_CELL_WIDTH) {
+                    s = {};
+                    s << std::setprecision(2 * TABLE_CELL_WIDTH - str.size() - MIN_INTEGER_PART_WIDTH) << std::setw(TABLE_CELL_WIDTH) << values[i][j];
+                    str = s.str();
+                }
+                std::cout << str << std::setw(TABLE_CELL_SPACING) << "";
+            }
+            std::cout << std::endl;
+        }
+    }
 }
\ No newline at end of file
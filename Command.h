@@ -1,166 +1,356 @@
-#ifndef COMMAND_H_
-#define COMMAND_H_
-#include "ValueParser.h"
-#include "Options.h"
-#include <vector>
-#include <string>
-
-namespace ParticleLife {
-    /// @brief represents a command the user can execute
-    class Command {
-    protected:
-        ValueParser parser_;
-        /// @brief print a table of float values
-        /// @param values the values to print
-        void Tabulate(std::vector<std::vector<float>>&& values) const;
-    public:
-        inline Command() : parser_() {}
-        /// @brief how many arguments does this command have
-        /// @return the number of arguments
-        inline virtual size_t argCount() const = 0;
-        /// @brief parse the arguments and run the command
-        /// @param options reference to options to modify
-        /// @param args command arguments as strings, the count is expected be correct (equal to argCount())
-        /// @return did the command succeed
-        virtual bool run(Options& options, const std::vector<std::string>& args) const = 0;
-        /// @brief print the corresponding current settings
-        /// @param options reference to options to read from
-        inline virtual void printCurrentSettings(const Options& options) const {}
-        /// @brief print the command description
-        virtual void printCommandDescription() const = 0;
-        /// @brief get the names of this command's arguments
-        /// @return vector of the names
-        inline virtual std::vector<std::string> getArguments() const { return {}; }
-    };
-
-    class FPSCommand : public Command {
-        inline size_t argCount() const override { return 1; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class TPSCommand : public Command {
-        inline size_t argCount() const override { return 1; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class TimeStepCommand : public Command {
-        inline size_t argCount() const override { return 1; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class SimSpeedCommand : public Command {
-        inline size_t argCount() const override { return 1; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class WorldSizeCommand : public Command {
-        inline size_t argCount() const override { return 1; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class FrictionCommand : public Command {
-        inline size_t argCount() const override { return 1; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class ParticleRadiusCommand : public Command {
-        inline size_t argCount() const override { return 1; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class RepulsionCommand : public Command {
-        inline size_t argCount() const override { return 1; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class ChunkCountCommand : public Command {
-        inline size_t argCount() const override { return 1; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class AddSpeciesCommand : public Command {
-        inline size_t argCount() const override { return 1; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class ParticleCountCommand : public Command {
-        inline size_t argCount() const override { return 2; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class ColorCommand : public Command {
-        inline size_t argCount() const override { return 4; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class AttractionCommand : public Command {
-        inline size_t argCount() const override { return 3; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class AttractionRangeCommand : public Command {
-        inline size_t argCount() const override { return 3; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class RepulsionRangeCommand : public Command {
-        inline size_t argCount() const override { return 3; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCurrentSettings(const Options& options) const override;
-        void printCommandDescription() const override;
-        std::vector<std::string> getArguments() const override;
-    };
-    class PauseCommand : public Command {
-        inline size_t argCount() const override { return 0; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCommandDescription() const override;
-    };
-    class StepCommand : public Command {
-        inline size_t argCount() const override { return 0; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCommandDescription() const override;
-    };
-    class ExitCommand : public Command {
-        inline size_t argCount() const override { return 0; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCommandDescription() const override;
-    };
-    class HelpCommand : public Command {
-    private:
-        const std::map<std::string, std::unique_ptr<Command>>& commands_;
-    public:
-        /// @param reference to map of command names to commands
-        inline HelpCommand(const std::map<std::string, std::unique_ptr<Command>>& commands) : Command(), commands_(commands) {}
-        inline size_t argCount() const override { return 0; }
-        bool run(Options& options, const std::vector<std::string>& args) const override;
-        void printCommandDescription() const override;
-    };
-}
+#ifndef COMMAND_H_
+#define COMMAND_H_
+#include "ValueParser.h"
+#include "Options.h"
+#include "Simulation.h"
+#include "CommandLog.h"
+#include "ControlServer.h"
+#include "LoopMetrics.h"
+#include <vector>
+#include <string>
+
+namespace ParticleLife {
+    /// @brief represents a command the user can execute
+    class Command {
+    protected:
+        ValueParser parser_;
+        /// @brief print a table of float values
+        /// @param values the values to print
+        void Tabulate(std::vector<std::vector<float>>&& values) const;
+        /// @brief get the largest attraction range between any two species
+        float getMaxAttractionRange(const Options& options) const;
+        /// @brief check that an attraction range spans at most MAX_CHUNK_RANGE chunks, so that the chunk pattern stays small, print an error otherwise
+        bool checkChunkRange(const Options& options, float range) const;
+    public:
+        inline Command() : parser_() {}
+        /// @brief how many arguments does this command have
+        /// @return the number of arguments
+        inline virtual size_t argCount() const = 0;
+        /// @brief parse the arguments and run the command
+        /// @param options reference to options to modify
+        /// @param args command arguments as strings, the count is expected be correct (equal to argCount())
+        /// @return did the command succeed
+        virtual bool run(Options& options, const std::vector<std::string>& args) const = 0;
+        /// @brief print the corresponding current settings
+        /// @param options reference to options to read from
+        inline virtual void printCurrentSettings(const Options& options) const {}
+        /// @brief print the command description
+        virtual void printCommandDescription() const = 0;
+        /// @brief get the names of this command's arguments
+        /// @return vector of the names
+        inline virtual std::vector<std::string> getArguments() const { return {}; }
+        /// @brief should the command be recorded in the command log, false for commands which don't change how the simulation evolves
+        inline virtual bool isLogged() const { return true; }
+    };
+
+    class FPSCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class TPSCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class TimeStepCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class SimSpeedCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class WorldSizeCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class FrictionCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ParticleRadiusCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class DisplayModeCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ViewCommand : public Command {
+        inline size_t argCount() const override { return 3; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class SmoothMotionCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class RepulsionCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ForceLawCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class TabulatedForceCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class QuiescenceCommand : public Command {
+    private:
+        const Simulation& simulation_;
+    public:
+        /// @param simulation simulation to report the reused forces of
+        inline QuiescenceCommand(const Simulation& simulation) : Command(), simulation_(simulation) {}
+        inline size_t argCount() const override { return 3; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ChunkCountCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class AddSpeciesCommand : public Command {
+        inline size_t argCount() const override { return 1; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ParticleCountCommand : public Command {
+        inline size_t argCount() const override { return 2; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ColorCommand : public Command {
+        inline size_t argCount() const override { return 4; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class AttractionCommand : public Command {
+        inline size_t argCount() const override { return 3; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class AttractionRangeCommand : public Command {
+        inline size_t argCount() const override { return 3; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class RepulsionRangeCommand : public Command {
+        inline size_t argCount() const override { return 3; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class SweepCommand : public Command {
+        inline size_t argCount() const override { return 3; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class AttractionSweepCommand : public Command {
+        inline size_t argCount() const override { return 6; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ExportCommand : public Command {
+        inline size_t argCount() const override { return 4; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class BenchmarkCommand : public Command {
+    private:
+        /// @brief run a headless simulation with given options
+        /// @param forceTableError set to the largest error of the tabulated force, 0 if forces aren't tabulated
+        /// @return average real time of one tick in milliseconds
+        double measure(const Options& options, size_t ticks, float& forceTableError) const;
+    public:
+        inline size_t argCount() const override { return 1; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ThreadsCommand : public Command {
+        inline size_t argCount() const override { return 2; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class PauseCommand : public Command {
+        inline size_t argCount() const override { return 0; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCommandDescription() const override;
+    };
+    class StepCommand : public Command {
+        inline size_t argCount() const override { return 0; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCommandDescription() const override;
+    };
+    class ExitCommand : public Command {
+        inline size_t argCount() const override { return 0; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCommandDescription() const override;
+    };
+    class ObservablesCommand : public Command {
+        inline size_t argCount() const override { return 2; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class SharedFramesCommand : public Command {
+        inline size_t argCount() const override { return 2; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ClustersCommand : public Command {
+    private:
+        const Simulation& simulation_;
+    public:
+        /// @param simulation simulation to report the clusters of
+        inline ClustersCommand(const Simulation& simulation) : Command(), simulation_(simulation) {}
+        inline size_t argCount() const override { return 2; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ControlCommand : public Command {
+    private:
+        ControlServer& server_;
+    public:
+        /// @param server server to start and stop
+        inline ControlCommand(ControlServer& server) : Command(), server_(server) {}
+        inline size_t argCount() const override { return 2; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class MetricsCommand : public Command {
+    private:
+        const LoopMetrics& metrics_;
+    public:
+        /// @param metrics latencies of the main loop to report
+        inline MetricsCommand(const LoopMetrics& metrics) : Command(), metrics_(metrics) {}
+        inline size_t argCount() const override { return 1; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class LogCommand : public Command {
+    private:
+        const CommandLog& log_;
+        const Simulation& simulation_;
+    public:
+        /// @param log log of the commands run so far
+        /// @param simulation simulation the logged commands were applied to
+        inline LogCommand(const CommandLog& log, const Simulation& simulation) : Command(), log_(log), simulation_(simulation) {}
+        inline size_t argCount() const override { return 1; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCurrentSettings(const Options& options) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class ReplayCommand : public Command {
+    private:
+        const std::map<std::string, std::unique_ptr<Command>>& commands_;
+    public:
+        /// @param reference to map of command names to commands
+        inline ReplayCommand(const std::map<std::string, std::unique_ptr<Command>>& commands) : Command(), commands_(commands) {}
+        inline size_t argCount() const override { return 1; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCommandDescription() const override;
+        std::vector<std::string> getArguments() const override;
+    };
+    class HelpCommand : public Command {
+    private:
+        const std::map<std::string, std::unique_ptr<Command>>& commands_;
+    public:
+        /// @param reference to map of command names to commands
+        inline HelpCommand(const std::map<std::string, std::unique_ptr<Command>>& commands) : Command(), commands_(commands) {}
+        inline size_t argCount() const override { return 0; }
+        inline bool isLogged() const override { return false; }
+        bool run(Options& options, const std::vector<std::string>& args) const override;
+        void printCommandDescription() const override;
+    };
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "CommandLog.h"
+#include <fstream>
+#include <sstream>
+namespace ParticleLife {
+    constexpr char SEED_KEYWORD[] = "seed";
+    constexpr char END_KEYWORD[] = "end";
+
+    CommandLog::CommandLog(uint64_t seed) : seed_(seed), endTick_(0), entries_() {}
+
+    void CommandLog::record(size_t tick, const std::vector<std::string>& args)
+    {
+        entries_.push_back({ tick, args });
+    }
+
+    bool CommandLog::save(const std::string& path, size_t endTick) const
+    {
+        std::ofstream out(path);
+        if (!out)
+            return false;
+        out << SEED_KEYWORD << " " << seed_ << "\n";
+        for (auto&& entry : entries_) {
+            out << entry.tick;
+            for (auto&& arg : entry.args) {
+                out << " " << arg;
+            }
+            out << "\n";
+        }
+        out << endTick << " " << END_KEYWORD << "\n";
+        return (bool)out;
+    }
+
+    bool CommandLog::load(const std::string& path)
+    {
+        std::ifstream in(path);
+        std::string keyword;
+        if (!(in >> keyword >> seed_) || keyword != SEED_KEYWORD)
+            return false;
+        entries_.clear();
+        endTick_ = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream stream(line);
+            Entry entry{};
+            if (!(stream >> entry.tick))
+                continue;
+            // ticks only ever grow, a log going back in time wasn't written by save
+            if (entry.tick < endTick_)
+                return false;
+            endTick_ = entry.tick;
+            std::string arg;
+            while (stream >> arg) {
+                entry.args.push_back(std::move(arg));
+            }
+            if (entry.args.size() == 1 && entry.args[0] == END_KEYWORD)
+                return true;
+            if (entry.args.empty())
+                return false;
+            entries_.push_back(std::move(entry));
+        }
+        // a log without its end still replays up to its last command
+        return true;
+    }
+}
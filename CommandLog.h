@@ -0,0 +1,46 @@
+#ifndef COMMAND_LOG_H_
+#define COMMAND_LOG_H_
+#include <vector>
+#include <string>
+#include <cstdint>
+namespace ParticleLife {
+    /// @brief commands which changed the simulation, each with the tick at which it took effect, enough to replay a session from its seed
+    class CommandLog {
+    public:
+        /// @brief one logged command
+        struct Entry {
+            /// @brief number of ticks simulated before the command took effect
+            size_t tick;
+            /// @brief command name followed by its arguments
+            std::vector<std::string> args;
+        };
+    private:
+        /// @brief seed of the options the session started with
+        uint64_t seed_;
+        /// @brief number of ticks simulated by the end of the session
+        size_t endTick_;
+        std::vector<Entry> entries_;
+    public:
+        /// @param seed seed of the options the session starts with
+        CommandLog(uint64_t seed);
+        /// @brief append a command
+        /// @param tick number of ticks simulated before the command took effect
+        /// @param args command name followed by its arguments
+        void record(size_t tick, const std::vector<std::string>& args);
+        /// @brief write the log into a file, one command per line prefixed by its tick
+        /// @param path file to write
+        /// @param endTick number of ticks simulated by now, ends the session
+        /// @return could the file be written
+        bool save(const std::string& path, size_t endTick) const;
+        /// @brief replace the contents of this log by a log written by save
+        /// @param path file to read
+        /// @return could the file be read and parsed
+        bool load(const std::string& path);
+        inline uint64_t getSeed() const { return seed_; }
+        /// @brief get number of ticks simulated by the end of a loaded session
+        inline size_t getEndTick() const { return endTick_; }
+        /// @brief get logged commands ordered by their tick
+        inline const std::vector<Entry>& getEntries() const { return entries_; }
+    };
+}
+#endif
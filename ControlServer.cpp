@@ -0,0 +1,346 @@
+#include "ControlServer.h"
+#include <sstream>
+#include <iomanip>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <random>
+#include <cstdlib>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+namespace ParticleLife {
+    /// @brief longest time the server thread waits for sockets before it checks for responses to send
+    constexpr long POLL_MICROSECONDS = 5000;
+    constexpr size_t RECEIVE_BUFFER_SIZE = 4096;
+    /// @brief clients sending longer lines are disconnected
+    constexpr size_t MAX_LINE_LENGTH = 65536;
+    constexpr int LISTEN_BACKLOG = 8;
+#ifdef _WIN32
+    /// @brief random 32 bit words forming the token
+    constexpr size_t TOKEN_WORDS = 4;
+#endif
+
+    ControlServer::ControlServer() : listener_(), endpoint_(), telemetryRate_(0), thread_(), running_(false), mutex_(), requests_(), responses_(), telemetry_(), clients_(), nextClient_(0)
+    {
+#ifdef _WIN32
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+    }
+
+    ControlServer::~ControlServer()
+    {
+        stop();
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    bool ControlServer::start(const std::string& endpoint, float telemetryRate)
+    {
+        stop();
+        if (endpoint.empty())
+            return true;
+#ifdef _WIN32
+        unsigned long port = std::strtoul(endpoint.c_str(), nullptr, 10);
+        if (port == 0 || port > UINT16_MAX)
+            return false;
+        Socket listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listener == INVALID_SOCKET)
+            return false;
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons((uint16_t)port);
+        // only local processes can connect, and of those only the ones given the token are served
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 || listen(listener, LISTEN_BACKLOG) != 0) {
+            closeSocket(listener);
+            return false;
+        }
+        std::random_device random;
+        std::ostringstream token;
+        for (size_t i = 0; i < TOKEN_WORDS; i++)
+        {
+            token << std::hex << std::setw(8) << std::setfill('0') << random();
+        }
+        token_ = token.str();
+#else
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (endpoint.size() >= sizeof(address.sun_path))
+            return false;
+        std::copy(endpoint.begin(), endpoint.end(), address.sun_path);
+        // a socket left behind by a crashed run is replaced, any other file is kept and makes bind fail
+        struct stat status;
+        if (lstat(endpoint.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+            unlink(endpoint.c_str());
+        Socket listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0)
+            return false;
+        // the socket file is created readable and writable only by the owner, so no other user can ever connect to it
+        mode_t mask = umask(S_IXUSR | S_IRWXG | S_IRWXO);
+        bool bound = bind(listener, (const sockaddr*)&address, sizeof(address)) == 0;
+        umask(mask);
+        if (!bound || listen(listener, LISTEN_BACKLOG) != 0) {
+            closeSocket(listener);
+            if (bound)
+                unlink(endpoint.c_str());
+            return false;
+        }
+#endif
+        listener_ = listener;
+        endpoint_ = endpoint;
+        telemetryRate_ = telemetryRate;
+        running_ = true;
+        thread_ = std::thread(&ControlServer::work, this);
+        return true;
+    }
+
+    void ControlServer::stop()
+    {
+        if (!running_)
+            return;
+        running_ = false;
+        thread_.join();
+        for (auto&& client : clients_) {
+            closeSocket(client.second.socket);
+        }
+        clients_.clear();
+        closeSocket(listener_);
+#ifndef _WIN32
+        unlink(endpoint_.c_str());
+#endif
+        endpoint_.clear();
+        std::lock_guard lock(mutex_);
+        requests_.clear();
+        responses_.clear();
+    }
+
+    std::vector<ControlServer::Request> ControlServer::takeRequests()
+    {
+        std::vector<Request> requests;
+        std::lock_guard lock(mutex_);
+        requests.swap(requests_);
+        return requests;
+    }
+
+    void ControlServer::respond(size_t client, std::string&& line)
+    {
+        if (!running_)
+            return;
+        std::lock_guard lock(mutex_);
+        responses_.push_back({ client, std::move(line) });
+    }
+
+    void ControlServer::publishTelemetry(const Telemetry& telemetry)
+    {
+        if (!running_ || telemetryRate_ == 0)
+            return;
+        std::lock_guard lock(mutex_);
+        telemetry_ = telemetry;
+    }
+
+    void ControlServer::work()
+    {
+        using Clock = std::chrono::steady_clock;
+        Clock::duration telemetryInterval = telemetryRate_ > 0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1 / telemetryRate_)) : Clock::duration::max();
+        Clock::time_point nextTelemetry = Clock::now();
+        while (running_) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(listener_, &readable);
+            Socket maxSocket = listener_;
+            for (auto&& client : clients_) {
+                FD_SET(client.second.socket, &readable);
+                maxSocket = std::max(maxSocket, client.second.socket);
+            }
+            timeval timeout{ 0, POLL_MICROSECONDS };
+            if (select((int)maxSocket + 1, &readable, nullptr, nullptr, &timeout) > 0) {
+                if (FD_ISSET(listener_, &readable))
+                    acceptClient();
+                for (auto it = clients_.begin(); it != clients_.end();) {
+                    if (FD_ISSET(it->second.socket, &readable) && !receive(it->first, it->second)) {
+                        closeSocket(it->second.socket);
+                        it = clients_.erase(it);
+                    }
+                    else
+                        it++;
+                }
+            }
+
+            std::deque<Request> responses;
+            std::string telemetry;
+            {
+                std::lock_guard lock(mutex_);
+                responses.swap(responses_);
+                if (telemetryRate_ > 0 && Clock::now() >= nextTelemetry) {
+                    telemetry = formatTelemetry(telemetry_);
+                    nextTelemetry += telemetryInterval;
+                    // a slow client mustn't cause a burst of telemetry to catch up
+                    nextTelemetry = std::max(nextTelemetry, Clock::now());
+                }
+            }
+            for (auto&& response : responses) {
+                auto client = clients_.find(response.client);
+                if (client != clients_.end() && !send(client->second, response.line)) {
+                    closeSocket(client->second.socket);
+                    clients_.erase(client);
+                }
+            }
+            if (telemetry.empty())
+                continue;
+            for (auto it = clients_.begin(); it != clients_.end();) {
+                if (it->second.authenticated && !send(it->second, telemetry)) {
+                    closeSocket(it->second.socket);
+                    it = clients_.erase(it);
+                }
+                else
+                    it++;
+            }
+        }
+    }
+
+    void ControlServer::acceptClient()
+    {
+        Socket socket = accept(listener_, nullptr, nullptr);
+#ifdef _WIN32
+        if (socket == INVALID_SOCKET)
+            return;
+#else
+        if (socket < 0)
+            return;
+        // select can't wait for sockets beyond FD_SETSIZE
+        if (socket >= FD_SETSIZE) {
+            closeSocket(socket);
+            return;
+        }
+#endif
+#ifdef _WIN32
+        clients_.emplace(nextClient_++, Client{ socket, {}, false });
+#else
+        clients_.emplace(nextClient_++, Client{ socket, {}, true });
+#endif
+    }
+
+    bool ControlServer::receive(size_t id, Client& client)
+    {
+        char buffer[RECEIVE_BUFFER_SIZE];
+        int received = recv(client.socket, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+            return false;
+        client.received.append(buffer, received);
+        size_t lineStart = 0;
+        size_t lineEnd;
+        std::vector<Request> lines;
+        while ((lineEnd = client.received.find('\n', lineStart)) != std::string::npos) {
+            std::string line = client.received.substr(lineStart, lineEnd - lineStart);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            lineStart = lineEnd + 1;
+#ifdef _WIN32
+            // anything else than the token first disconnects the client
+            if (!client.authenticated) {
+                if (line != token_)
+                    return false;
+                client.authenticated = true;
+                continue;
+            }
+#endif
+            lines.push_back({ id, std::move(line) });
+        }
+        client.received.erase(0, lineStart);
+        if (client.received.size() > MAX_LINE_LENGTH)
+            return false;
+        if (!lines.empty()) {
+            std::lock_guard lock(mutex_);
+            for (auto&& line : lines) {
+                requests_.push_back(std::move(line));
+            }
+        }
+        return true;
+    }
+
+    bool ControlServer::send(const Client& client, const std::string& line) const
+    {
+        std::string data = line + "\n";
+        size_t sent = 0;
+        while (sent < data.size()) {
+#ifdef MSG_NOSIGNAL
+            // a disconnected client mustn't kill the program by SIGPIPE
+            int flags = MSG_NOSIGNAL;
+#else
+            int flags = 0;
+#endif
+            int result = ::send(client.socket, data.data() + sent, (int)(data.size() - sent), flags);
+            if (result <= 0)
+                return false;
+            sent += result;
+        }
+        return true;
+    }
+
+    std::string ControlServer::formatTelemetry(const Telemetry& telemetry)
+    {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3)
+            << "{\"type\":\"telemetry\",\"tick\":" << telemetry.tick
+            << ",\"time\":" << telemetry.time
+            << ",\"tps\":" << telemetry.tps
+            << ",\"fps\":" << telemetry.fps
+            << ",\"paused\":" << (telemetry.paused ? "true" : "false")
+            << ",\"phases\":{\"setup\":" << telemetry.phases.setup
+            << ",\"chunks\":" << telemetry.phases.chunks
+            << ",\"clusters\":" << telemetry.phases.clusters
+            << ",\"particles\":" << telemetry.phases.particles
+            << ",\"total\":" << telemetry.phases.total << "}}";
+        return out.str();
+    }
+
+    std::string ControlServer::escapeJson(const std::string& text)
+    {
+        std::ostringstream out;
+        for (char c : text) {
+            switch (c)
+            {
+            case '"':
+                out << "\\\"";
+                break;
+            case '\\':
+                out << "\\\\";
+                break;
+            case '\n':
+                out << "\\n";
+                break;
+            case '\r':
+                out << "\\r";
+                break;
+            case '\t':
+                out << "\\t";
+                break;
+            default:
+                if ((unsigned char)c < 0x20)
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec;
+                else
+                    out << c;
+            }
+        }
+        return out.str();
+    }
+
+    void ControlServer::closeSocket(Socket socket)
+    {
+#ifdef _WIN32
+        closesocket(socket);
+#else
+        close(socket);
+#endif
+    }
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#ifndef CONTROL_SERVER_H
+#define CONTROL_SERVER_H
+#include "Simulation.h"
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+namespace ParticleLife {
+    /// @brief state of the program sent to control clients
+    struct Telemetry {
+        /// @brief number of ticks simulated
+        size_t tick;
+        /// @brief time simulated
+        double time;
+        /// @brief average ticks per second
+        double tps;
+        /// @brief average frames per second
+        double fps;
+        bool paused;
+        /// @brief phase times of the last tick
+        TickPhaseTimes phases;
+    };
+
+    /// @brief accepts commands from local scripts and streams telemetry to them, all socket work is done by its own thread
+    /// @details commands can write files wherever they are told to, so only the user running the program may send them:
+    /// on POSIX the server listens on a Unix domain socket only its owner can connect to,
+    /// on Windows it listens on TCP on 127.0.0.1 and a client's first line has to be the token generated by start,
+    /// each other line a client sends is a batch of commands separated by ';', executed by the main thread,
+    /// the client gets back one JSON line with the result and output of each command of the batch,
+    /// every client also receives telemetry JSON lines at the configured rate
+    class ControlServer {
+    public:
+        /// @brief one batch of commands received from a client
+        struct Request {
+            /// @brief id of the client to send the response to
+            size_t client;
+            /// @brief the received line
+            std::string line;
+        };
+    private:
+#ifdef _WIN32
+        using Socket = uintptr_t;
+#else
+        using Socket = int;
+#endif
+        /// @brief connection to one client
+        struct Client {
+            Socket socket;
+            /// @brief received data not yet ending with a new line
+            std::string received;
+            /// @brief has the client sent the token, always true where no token is needed
+            bool authenticated;
+        };
+        /// @brief listening socket, valid while the server runs
+        Socket listener_;
+        /// @brief socket path on POSIX, TCP port on Windows, empty if the server isn't running
+        std::string endpoint_;
+#ifdef _WIN32
+        /// @brief random token clients have to send first
+        std::string token_;
+#endif
+        /// @brief telemetry lines sent to each client per second, 0 for none
+        float telemetryRate_;
+        std::thread thread_;
+        std::atomic<bool> running_;
+        std::mutex mutex_;
+        /// @brief received requests waiting for the main thread
+        std::vector<Request> requests_;
+        /// @brief responses waiting to be sent, in the order they were made
+        std::deque<Request> responses_;
+        /// @brief latest published telemetry
+        Telemetry telemetry_;
+        /// @brief connected clients indexed by their id, only accessed by the server thread
+        std::map<size_t, Client> clients_;
+        size_t nextClient_;
+        /// @brief loop of the server thread
+        void work();
+        /// @brief accept a waiting connection
+        void acceptClient();
+        /// @brief read data from a client and queue its complete lines
+        /// @return is the client still connected
+        bool receive(size_t id, Client& client);
+        /// @brief send one line to a client, waiting until it is sent
+        /// @return is the client still connected
+        bool send(const Client& client, const std::string& line) const;
+        /// @brief format telemetry as a JSON line
+        static std::string formatTelemetry(const Telemetry& telemetry);
+        static void closeSocket(Socket socket);
+    public:
+        ControlServer();
+        ~ControlServer();
+        ControlServer(const ControlServer&) = delete;
+        ControlServer& operator=(const ControlServer&) = delete;
+        /// @brief stop the running server and start listening on another endpoint
+        /// @param endpoint path of a Unix domain socket on POSIX, TCP port on 127.0.0.1 on Windows, empty only stops the server
+        /// @param telemetryRate telemetry lines sent to each client per second, 0 for none
+        /// @return could the endpoint be opened
+        bool start(const std::string& endpoint, float telemetryRate);
+        /// @brief disconnect all clients and stop listening
+        void stop();
+        /// @brief get the endpoint the server listens on, empty if it isn't running
+        inline const std::string& getEndpoint() const { return endpoint_; }
+#ifdef _WIN32
+        /// @brief get the token clients have to send as their first line
+        inline const std::string& getToken() const { return token_; }
+#endif
+        /// @brief get telemetry lines sent to each client per second
+        inline float getTelemetryRate() const { return telemetryRate_; }
+        /// @brief take all requests received since the last call
+        std::vector<Request> takeRequests();
+        /// @brief queue a response to be sent to a client, ignored if the client disconnected
+        /// @param client id of the client
+        /// @param line one line of JSON without the new line
+        void respond(size_t client, std::string&& line);
+        /// @brief replace the telemetry sent to clients, cheap enough to call every tick
+        void publishTelemetry(const Telemetry& telemetry);
+        /// @brief escape a string to be put between quotes in JSON
+        static std::string escapeJson(const std::string& text);
+    };
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,121 @@
+#ifndef FORCE_LAWS_H
+#define FORCE_LAWS_H
+#include <cmath>
+#include <algorithm>
+namespace ParticleLife {
+    /// @brief how the force between two particles depends on their distance
+    enum class ForceLaw {
+        /// @brief quadratic repulsion, then attraction rising linearly to its peak halfway through the attraction range and falling linearly back to 0
+        PiecewiseLinear,
+        /// @brief quadratic repulsion, then attraction with the same peak, smoothed by a cubic so that it has no kinks
+        SmoothCubic,
+        /// @brief steep repulsion and an attraction well shaped like the Lennard-Jones force, tapered to 0 at the attraction range
+        LennardJones
+    };
+
+    // Force laws are policies of the force kernel, which is instantiated for each of them, so the law is chosen once per tick instead of once per pair.
+    // Each law gets the interaction of the two species, their distance (less than the attraction range) and the peak repulsion strength,
+    // and returns the magnitude of the force towards the other particle, negative values push the particles apart.
+
+    /// @brief the original force law, see ForceLaw::PiecewiseLinear
+    struct PiecewiseLinearForce {
+        template <class Interaction>
+        static inline float getForce(const Interaction& interaction, float distance, float repulsion) {
+            if (distance < interaction.repulsionRange) {
+                float overlap = 1 - distance / interaction.repulsionRange;
+                return -repulsion * overlap * overlap;
+            }
+            else if (distance < interaction.peak) {
+                return (distance - interaction.repulsionRange) * interaction.attractionChange;
+            }
+            else {
+                return (interaction.attractionRange - distance) * interaction.attractionChange;
+            }
+        }
+    };
+
+    /// @brief see ForceLaw::SmoothCubic
+    struct SmoothCubicForce {
+        template <class Interaction>
+        static inline float getForce(const Interaction& interaction, float distance, float repulsion) {
+            if (distance < interaction.repulsionRange) {
+                float overlap = 1 - distance / interaction.repulsionRange;
+                return -repulsion * overlap * overlap;
+            }
+            // the piecewise linear attraction relative to its peak, passed through smoothstep
+            float t = 1 - std::abs(distance - interaction.peak) * interaction.halfWidthInverse;
+            return interaction.attraction * t * t * (3 - 2 * t);
+        }
+    };
+
+    /// @brief see ForceLaw::LennardJones
+    struct LennardJonesForce {
+        template <class Interaction>
+        static inline float getForce(const Interaction& interaction, float distance, float repulsion) {
+            // the repulsion range plays the role of sigma, where the force changes sign
+            // r^12 - r^6 exceeds the cap already at a ratio of about 1.08, beyond 2 it would only overflow into inf - inf at tiny distances
+            constexpr float MAX_RATIO = 2;
+            float ratio = std::min(interaction.repulsionRange / distance, MAX_RATIO);
+            float ratio6 = ratio * ratio * ratio;
+            ratio6 *= ratio6;
+            if (distance < interaction.repulsionRange) {
+                // capped at the peak repulsion strength, the uncapped force would launch overlapping particles across the world
+                return -repulsion * std::min(ratio6 * ratio6 - ratio6, 1.0f);
+            }
+            // 4 * (r^6 - r^12) peaks at 1, 2^(1/6) repulsion ranges away
+            float taper = (interaction.attractionRange - distance) * interaction.widthInverse;
+            return interaction.attraction * 4 * (ratio6 - ratio6 * ratio6) * taper;
+        }
+    };
+
+    /// @brief approximation of another law: force / distance sampled at evenly spaced squared distances and linearly interpolated,
+    /// the force vector is then the difference of positions times the interpolated value, with no square root, division or branch per pair
+    struct TabulatedForce {
+        /// @brief number of intervals between table entries of each interaction
+        static constexpr size_t TABLE_SIZE = 1024;
+
+        /// @brief get force / distance from the table of the interaction
+        /// @param distanceSquared squared distance, less than the squared attraction range
+        template <class Interaction>
+        static inline float getForceOverDistance(const Interaction& interaction, float distanceSquared) {
+            float x = distanceSquared * interaction.forceTableScale;
+            // rounding can put a distance just below the attraction range at the last entry, which has no next one
+            size_t i = std::min((size_t)x, TABLE_SIZE - 1);
+            const float* entry = interaction.forceTable + i;
+            return entry[0] + (entry[1] - entry[0]) * (x - i);
+        }
+
+        /// @brief sample a law into the table of an interaction
+        /// @tparam Law force law policy to approximate
+        /// @param table TABLE_SIZE + 1 entries to fill
+        template <class Law, class Interaction>
+        static void fill(float* table, const Interaction& interaction, float repulsion) {
+            float step = interaction.attractionRangeSquared / TABLE_SIZE;
+            for (size_t i = 1; i <= TABLE_SIZE; i++)
+            {
+                float distance = std::sqrt(step * i);
+                table[i] = Law::getForce(interaction, distance, repulsion) / distance;
+            }
+            // force / distance has no finite value at distance 0, so within the first interval the force shrinks linearly to 0 instead
+            table[0] = table[1];
+        }
+
+        /// @brief get the largest difference between the law and its table beyond the first table entry, measured between the entries
+        /// @tparam Law force law policy the table approximates
+        template <class Law, class Interaction>
+        static float getMaxError(const Interaction& interaction, float repulsion) {
+            constexpr size_t SAMPLES_PER_INTERVAL = 8;
+            float step = interaction.attractionRangeSquared / TABLE_SIZE;
+            float maxError = 0;
+            for (size_t i = SAMPLES_PER_INTERVAL; i < TABLE_SIZE * SAMPLES_PER_INTERVAL; i++)
+            {
+                float distanceSquared = step * i / SAMPLES_PER_INTERVAL;
+                float distance = std::sqrt(distanceSquared);
+                float error = Law::getForce(interaction, distance, repulsion) - getForceOverDistance(interaction, distanceSquared) * distance;
+                maxError = std::max(maxError, std::abs(error));
+            }
+            return maxError;
+        }
+    };
+}
+#endif
\ No newline at end of file
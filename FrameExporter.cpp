@@ -0,0 +1,127 @@
+#include "FrameExporter.h"
+#include <filesystem>
+#include <format>
+#include <algorithm>
+namespace ParticleLife {
+    /// @brief maximum number of frames waiting to be saved, each holds a copy of all particle positions, the simulation waits once there are this many
+    constexpr size_t MAX_QUEUED_FRAMES = 32;
+    constexpr char RAW_EXTENSION[] = ".rgba";
+    constexpr char PNG_EXTENSION[] = ".png";
+    constexpr char FRAME_INDEX_FORMAT[] = "_{:05}";
+
+    FrameExporter::FrameExporter(const std::string& path, unsigned int size, size_t threadCount) :
+        path_(path), size_(size), raw_(std::filesystem::path(path).extension() == RAW_EXTENSION), rawFile_(), threads_(), mutex_(), queued_(), frameWritten_(), dequeued_(), queue_(),
+        accepted_(0), nextRawFrame_(0), writtenCount_(0), failed_(0), finishing_(false)
+    {
+        if (raw_) {
+            rawFile_.open(path, std::ios::binary);
+            if (!rawFile_)
+                return;
+        }
+        for (size_t i = 0; i < std::max((size_t)1, threadCount); i++)
+        {
+            threads_.emplace_back(&FrameExporter::work, this);
+        }
+    }
+
+    FrameExporter::~FrameExporter()
+    {
+        finish();
+    }
+
+    bool FrameExporter::isOpen() const
+    {
+        return !raw_ || rawFile_.is_open();
+    }
+
+    bool FrameExporter::submit(FrameSnapshot&& snapshot)
+    {
+        {
+            std::unique_lock lock(mutex_);
+            // a frame left out would make the output jump in time without a trace, so the simulation waits for the encoding threads instead
+            dequeued_.wait(lock, [this] { return threads_.empty() || queue_.size() < MAX_QUEUED_FRAMES; });
+            if (threads_.empty())
+                return false;
+            queue_.push_back({ accepted_++, std::move(snapshot) });
+        }
+        queued_.notify_one();
+        return true;
+    }
+
+    void FrameExporter::finish()
+    {
+        {
+            std::lock_guard lock(mutex_);
+            finishing_ = true;
+        }
+        queued_.notify_all();
+        for (auto&& thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+        if (raw_)
+            rawFile_.flush();
+    }
+
+    void FrameExporter::work()
+    {
+        Rasterizer rasterizer(size_);
+        while (true) {
+            Frame frame;
+            {
+                std::unique_lock lock(mutex_);
+                queued_.wait(lock, [this] { return finishing_ || !queue_.empty(); });
+                if (queue_.empty())
+                    return;
+                frame = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            dequeued_.notify_one();
+            rasterizer.draw(frame.snapshot);
+            bool saved = save(frame.index, rasterizer);
+            std::lock_guard lock(mutex_);
+            if (saved)
+                writtenCount_++;
+            else
+                failed_++;
+        }
+    }
+
+    bool FrameExporter::save(size_t index, const Rasterizer& rasterizer)
+    {
+        if (!raw_) {
+            sf::Image image;
+            image.create(size_, size_, rasterizer.getPixels().data());
+            return image.saveToFile(getFrameFileName(index));
+        }
+        // raw frames form one stream, so they have to be written in order
+        std::unique_lock lock(mutex_);
+        frameWritten_.wait(lock, [this, index] { return nextRawFrame_ == index; });
+        rawFile_.write((const char*)rasterizer.getPixels().data(), rasterizer.getPixels().size());
+        bool saved = (bool)rawFile_;
+        nextRawFrame_++;
+        lock.unlock();
+        frameWritten_.notify_all();
+        return saved;
+    }
+
+    std::string FrameExporter::getFrameFileName(size_t index) const
+    {
+        std::filesystem::path path(path_);
+        std::filesystem::path extension = path.has_extension() ? path.extension() : std::filesystem::path(PNG_EXTENSION);
+        path.replace_extension();
+        return path.string() + std::format(FRAME_INDEX_FORMAT, index) + extension.string();
+    }
+
+    size_t FrameExporter::getWrittenCount() const
+    {
+        std::lock_guard lock(mutex_);
+        return writtenCount_;
+    }
+
+    size_t FrameExporter::getFailedCount() const
+    {
+        std::lock_guard lock(mutex_);
+        return failed_;
+    }
+}
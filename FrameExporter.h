@@ -0,0 +1,74 @@
+#ifndef FRAME_EXPORTER_H
+#define FRAME_EXPORTER_H
+#include "Rasterizer.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+namespace ParticleLife {
+    /// @brief draws and saves frames on background threads, so the simulation doesn't wait for encoding unless the queue is full
+    class FrameExporter {
+    private:
+        struct Frame {
+            /// @brief order of the frame among accepted frames
+            size_t index;
+            FrameSnapshot snapshot;
+        };
+        /// @brief PNG files are saved as path with the frame index inserted before the extension
+        std::string path_;
+        /// @brief width and height of frames in pixels
+        unsigned int size_;
+        /// @brief are frames appended as raw RGBA into one file instead of separate PNG files
+        bool raw_;
+        std::ofstream rawFile_;
+        std::vector<std::thread> threads_;
+        /// @brief guards the queue, the raw file and the counters
+        mutable std::mutex mutex_;
+        /// @brief signals a new frame in the queue or finishing
+        std::condition_variable queued_;
+        /// @brief signals a frame was written
+        std::condition_variable frameWritten_;
+        /// @brief signals a frame was taken from the queue
+        std::condition_variable dequeued_;
+        std::deque<Frame> queue_;
+        /// @brief number of accepted frames
+        size_t accepted_;
+        /// @brief index of the next raw frame to be appended, raw frames are written in order of their index
+        size_t nextRawFrame_;
+        /// @brief number of frames saved successfully
+        size_t writtenCount_;
+        /// @brief number of frames which failed to be saved
+        size_t failed_;
+        bool finishing_;
+        /// @brief loop of one encoding thread
+        void work();
+        /// @brief save one drawn frame
+        /// @return did it succeed
+        bool save(size_t index, const Rasterizer& rasterizer);
+        /// @brief get file name of a PNG frame
+        std::string getFrameFileName(size_t index) const;
+    public:
+        /// @param path output file, frames are appended as raw RGBA into it if it ends with ".rgba", otherwise each is saved as a PNG file with its index added to the name
+        /// @param size width and height of frames in pixels
+        /// @param threadCount number of encoding threads
+        FrameExporter(const std::string& path, unsigned int size, size_t threadCount);
+        ~FrameExporter();
+        FrameExporter(const FrameExporter&) = delete;
+        FrameExporter& operator=(const FrameExporter&) = delete;
+        /// @brief could the output be opened
+        bool isOpen() const;
+        /// @brief queue a frame to be drawn and saved, waits while the queue is full, so that no frame is left out of the output
+        /// @return false if the output couldn't be opened and the frame was discarded
+        bool submit(FrameSnapshot&& snapshot);
+        /// @brief wait until all accepted frames are saved and stop the threads
+        void finish();
+        /// @brief get number of frames saved successfully
+        size_t getWrittenCount() const;
+        /// @brief get number of frames which failed to be saved
+        size_t getFailedCount() const;
+    };
+}
+#endif
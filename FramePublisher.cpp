@@ -0,0 +1,194 @@
+#include "FramePublisher.h"
+#include <algorithm>
+#include <new>
+#include <cctype>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+namespace ParticleLife {
+    /// @brief frames in the ring, a reader copying one frame has this many ticks before the writer comes back to its slot
+    constexpr uint32_t SLOT_COUNT = 4;
+    /// @brief header and slots start on their own cache lines
+    constexpr size_t ALIGNMENT = 64;
+    /// @brief a region too small for the particles is replaced by one with this many times more room, so it doesn't grow every tick
+    constexpr size_t GROWTH_FACTOR = 2;
+    constexpr size_t MAX_NAME_LENGTH = 200;
+
+    static size_t alignUp(size_t size) {
+        return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    FramePublisher::FramePublisher() : name_(), first_(), current_(), generation_(0) {}
+
+    FramePublisher::~FramePublisher()
+    {
+        close();
+    }
+
+    bool FramePublisher::isValidName(const std::string& name)
+    {
+        return !name.empty() && name.size() <= MAX_NAME_LENGTH && std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum((unsigned char)c) || c == '_' || c == '-' || c == '.'; });
+    }
+
+    std::string FramePublisher::getRegionName(uint32_t generation) const
+    {
+        return generation == 0 ? name_ : name_ + "." + std::to_string(generation);
+    }
+
+    size_t FramePublisher::countParticles(const std::vector<ParticleVector>& particles)
+    {
+        size_t count = 0;
+        for (auto&& species : particles) {
+            count += species.size();
+        }
+        return count;
+    }
+
+    bool FramePublisher::open(const std::string& name, const std::vector<ParticleVector>& particles)
+    {
+        close();
+        if (name.empty())
+            return true;
+        name_ = name;
+        // sized for the particles right away, so the first frame doesn't have to replace the region
+        if (!map(name_, countParticles(particles), first_)) {
+            name_.clear();
+            return false;
+        }
+        current_ = first_;
+        return true;
+    }
+
+    void FramePublisher::close()
+    {
+        if (generation_ != 0)
+            unmap(getRegionName(generation_), current_);
+        unmap(name_, first_);
+        current_ = first_;
+        generation_ = 0;
+        name_.clear();
+    }
+
+    bool FramePublisher::map(const std::string& name, size_t capacity, Region& region)
+    {
+        size_t slotSize = alignUp(sizeof(SharedFrameSlot) + capacity * (2 * sizeof(float) + sizeof(uint16_t)));
+        size_t size = alignUp(sizeof(SharedFrameHeader)) + SLOT_COUNT * slotSize;
+        void* memory;
+#ifdef _WIN32
+        HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, ("Local\\" + name).c_str());
+        if (mapping == nullptr)
+            return false;
+        // a reader still holding a region of an earlier run keeps it alive under the same name, and it can't be resized
+        if (GetLastError() == ERROR_ALREADY_EXISTS) {
+            CloseHandle(mapping);
+            return false;
+        }
+        memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (memory == nullptr) {
+            CloseHandle(mapping);
+            return false;
+        }
+        region.mapping = mapping;
+#else
+        std::string path = "/" + name;
+        // a region left behind by a crashed run is replaced, readers still holding it keep their old mapping
+        shm_unlink(path.c_str());
+        int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+        if (fd < 0)
+            return false;
+        if (ftruncate(fd, size) != 0) {
+            ::close(fd);
+            shm_unlink(path.c_str());
+            return false;
+        }
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            shm_unlink(path.c_str());
+            return false;
+        }
+#endif
+        region.header = new (memory) SharedFrameHeader{ SHARED_FRAME_MAGIC, SHARED_FRAME_VERSION, SLOT_COUNT, 0, capacity, slotSize, 0, 0 };
+        for (size_t slot = 0; slot < SLOT_COUNT; slot++)
+        {
+            new ((char*)memory + alignUp(sizeof(SharedFrameHeader)) + slot * slotSize) SharedFrameSlot{ 0, 0, 0, 0, 0, 0 };
+        }
+        region.size = size;
+        return true;
+    }
+
+    void FramePublisher::unmap(const std::string& name, Region& region)
+    {
+        if (region.header == nullptr)
+            return;
+        region.header->stale = 1;
+#ifdef _WIN32
+        UnmapViewOfFile(region.header);
+        CloseHandle(region.mapping);
+        region.mapping = nullptr;
+#else
+        munmap(region.header, region.size);
+        shm_unlink(("/" + name).c_str());
+#endif
+        region.header = nullptr;
+        region.size = 0;
+    }
+
+    bool FramePublisher::publish(const std::vector<ParticleVector>& particles, size_t tick, double time, float worldSize)
+    {
+        if (current_.header == nullptr)
+            return true;
+        size_t count = countParticles(particles);
+        if (count > current_.header->capacity) {
+            // the bigger region gets a new name, as on Windows a reader holding the old one keeps the name taken
+            Region grown{};
+            if (!map(getRegionName(generation_ + 1), count * GROWTH_FACTOR, grown)) {
+                close();
+                return false;
+            }
+            // readers finding their region stale look up the generation, so it's set first
+            first_.header->generation.store(generation_ + 1, std::memory_order_release);
+            if (generation_ == 0)
+                first_.header->stale = 1;
+            else
+                unmap(getRegionName(generation_), current_);
+            generation_++;
+            current_ = grown;
+        }
+
+        SharedFrameHeader* header = current_.header;
+        uint64_t frame = header->publishedFrames.load(std::memory_order_relaxed);
+        char* slotStart = (char*)header + alignUp(sizeof(SharedFrameHeader)) + frame % header->slotCount * header->slotSize;
+        SharedFrameSlot& slot = *(SharedFrameSlot*)slotStart;
+        uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.tick = tick;
+        slot.time = time;
+        slot.worldSize = worldSize;
+        slot.speciesCount = (uint32_t)particles.size();
+        slot.particleCount = count;
+        // positions are gathered straight into the slot, there is no copy in between
+        float* positions = (float*)(slotStart + sizeof(SharedFrameSlot));
+        uint16_t* species = (uint16_t*)(positions + 2 * count);
+        for (size_t s = 0; s < particles.size(); s++)
+        {
+            for (auto&& p : particles[s]) {
+                *positions++ = p.getPosition().x;
+                *positions++ = p.getPosition().y;
+            }
+            species = std::fill_n(species, particles[s].size(), (uint16_t)s);
+        }
+
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        // the pointer flip: readers looking for the latest frame now find this slot
+        header->publishedFrames.store(frame + 1, std::memory_order_release);
+        return true;
+    }
+}
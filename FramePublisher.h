@@ -0,0 +1,104 @@
+#ifndef FRAME_PUBLISHER_H
+#define FRAME_PUBLISHER_H
+#include "Particle.h"
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+namespace ParticleLife {
+    /// @brief start of the shared memory region, followed by SharedFrameHeader::slotCount slots of SharedFrameHeader::slotSize bytes
+    /// @details the layout is meant to be read by other processes, all fields are little endian on the platforms the program runs on
+    struct SharedFrameHeader {
+        /// @brief SHARED_FRAME_MAGIC
+        uint32_t magic;
+        /// @brief SHARED_FRAME_VERSION
+        uint32_t version;
+        /// @brief number of frame slots in the ring
+        uint32_t slotCount;
+        /// @brief set to 1 once frames are no longer published into this region, readers should then look up generation in the region with the plain name again
+        std::atomic<uint32_t> stale;
+        /// @brief maximum number of particles of one frame
+        uint64_t capacity;
+        /// @brief bytes between the starts of two slots
+        uint64_t slotSize;
+        /// @brief number of frames published so far, the latest one is in slot (publishedFrames - 1) % slotCount
+        std::atomic<uint64_t> publishedFrames;
+        /// @brief only in the region with the plain name: the region frames are published into, 0 for this one, otherwise the one named "<name>.<generation>"
+        std::atomic<uint32_t> generation;
+    };
+
+    /// @brief start of each slot, followed by particleCount pairs of float x and y positions and then particleCount uint16_t species ids
+    /// @details sequence is a seqlock: a reader copies the frame and then checks that sequence was even and unchanged during the copy
+    struct SharedFrameSlot {
+        /// @brief odd while the slot is being written
+        std::atomic<uint64_t> sequence;
+        /// @brief number of ticks simulated when the frame was taken
+        uint64_t tick;
+        /// @brief time simulated when the frame was taken
+        double time;
+        /// @brief width and height of the world
+        float worldSize;
+        uint32_t speciesCount;
+        uint64_t particleCount;
+    };
+
+    constexpr uint32_t SHARED_FRAME_MAGIC = 0x464c5250;
+    constexpr uint32_t SHARED_FRAME_VERSION = 2;
+
+    /// @brief publishes particle positions and species into a named shared memory region as a ring of frames, so that other processes can map it and read them without copying through pipes or files
+    class FramePublisher {
+    private:
+        /// @brief a mapped shared memory region
+        struct Region {
+            /// @brief start of the region, nullptr if there is none
+            SharedFrameHeader* header;
+            /// @brief size of the region in bytes
+            size_t size;
+#ifdef _WIN32
+            /// @brief handle of the file mapping
+            void* mapping;
+#endif
+        };
+
+        std::string name_;
+        /// @brief the region with the plain name, which readers map first, it stays mapped while the publisher is open
+        Region first_;
+        /// @brief the region frames are published into, the same as first_ until the particles outgrow it
+        Region current_;
+        /// @brief number of times the region grew
+        uint32_t generation_;
+        /// @brief get the name of the region of a generation
+        std::string getRegionName(uint32_t generation) const;
+        /// @brief create a region for a given number of particles per frame
+        /// @return could the region be created
+        static bool map(const std::string& name, size_t capacity, Region& region);
+        /// @brief mark a region stale, unmap it and remove its name
+        static void unmap(const std::string& name, Region& region);
+        /// @brief get the number of particles of all species
+        static size_t countParticles(const std::vector<ParticleVector>& particles);
+    public:
+        FramePublisher();
+        ~FramePublisher();
+        FramePublisher(const FramePublisher&) = delete;
+        FramePublisher& operator=(const FramePublisher&) = delete;
+        /// @brief remove the current region and create another one, empty name only removes it
+        /// @param name name of the shared memory region, without the leading "/" POSIX requires
+        /// @param particles particles split by species, the region is sized for them
+        /// @return could the region be created
+        bool open(const std::string& name, const std::vector<ParticleVector>& particles);
+        /// @brief remove the region
+        void close();
+        /// @brief get name of the region, empty if there is none
+        inline const std::string& getName() const { return name_; }
+        /// @brief write particles into the next slot of the ring, growing the region if they don't fit
+        /// @param particles particles split by species
+        /// @param tick number of ticks simulated
+        /// @param time time simulated
+        /// @param worldSize width and height of the world
+        /// @return false if the region had to grow and couldn't, the publisher is closed then
+        bool publish(const std::vector<ParticleVector>& particles, size_t tick, double time, float worldSize);
+        /// @brief can the name be used for a shared memory region on all platforms
+        static bool isValidName(const std::string& name);
+    };
+}
+#endif
\ No newline at end of file
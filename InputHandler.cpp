@@ -1,96 +1,151 @@
-#include "InputHandler.h"
-#include <iostream>
-#include <sstream>
-namespace ParticleLife {
-    constexpr char PROMPT[] = "> ";
-
-    InputHandler::InputHandler(Options& options) : commandHandler_(options), options_(options) {}
-
-    //taken from https://stackoverflow.com/a/71992965
-#if defined(__GNUG__) || defined(__GNUC__)
-#define OS_LINUX
-#elif defined(_MAC)
-#define OS_MAC
-#elif defined(_WIN32)
-#define OS_WIN
-#endif
-#ifdef OS_WIN
-#include <conio.h>
-#elif defined(OS_LINUX) || defined(OS_MAC)
-#include <unistd.h>
-#include <sys/socket.h>
-#endif
-    bool InputHandler::stdinHasData() const
-    {
-#   if defined(OS_WIN)
-        // this works by harnessing Windows' black magic:
-        return _kbhit();
-#   elif defined(OS_LINUX) || defined(OS_MAC) 
-        // using a timeout of 0 so we aren't waiting:
-        struct timespec timeout { 0l, 0l };
-
-        // create a file descriptor set
-        fd_set fds{};
-
-        // initialize the fd_set to 0
-        FD_ZERO(&fds);
-        // set the fd_set to target file descriptor 0 (STDIN)
-        FD_SET(0, &fds);
-
-        // pselect the number of file descriptors that are ready, since
-        //  we're only passing in 1 file descriptor, it will return either
-        //  a 0 if STDIN isn't ready, or a 1 if it is.
-        return pselect(0 + 1, &fds, nullptr, nullptr, &timeout, nullptr) == 1;
-#   else
-        // throw a compiler error
-        static_assert(false, "Failed to detect a supported operating system!");
-#   endif
-    }
-
-    void InputHandler::init() {
-        commandHandler_.registerCommand("help", std::make_unique<HelpCommand>(commandHandler_.getCommands()));
-        commandHandler_.registerCommand("fps", std::make_unique<FPSCommand>());
-        commandHandler_.registerCommand("tps", std::make_unique<TPSCommand>());
-        commandHandler_.registerCommand("ts", std::make_unique<TimeStepCommand>());
-        commandHandler_.registerCommand("ss", std::make_unique<SimSpeedCommand>());
-        commandHandler_.registerCommand("ws", std::make_unique<WorldSizeCommand>());
-        commandHandler_.registerCommand("f", std::make_unique<FrictionCommand>());
-        commandHandler_.registerCommand("dr", std::make_unique<ParticleRadiusCommand>());
-        commandHandler_.registerCommand("r", std::make_unique<RepulsionCommand>());
-        commandHandler_.registerCommand("cc", std::make_unique<ChunkCountCommand>());
-        commandHandler_.registerCommand("add", std::make_unique<AddSpeciesCommand>());
-        commandHandler_.registerCommand("sc", std::make_unique<ParticleCountCommand>());
-        commandHandler_.registerCommand("dc", std::make_unique<ColorCommand>());
-        commandHandler_.registerCommand("sa", std::make_unique<AttractionCommand>());
-        commandHandler_.registerCommand("sar", std::make_unique<AttractionRangeCommand>());
-        commandHandler_.registerCommand("srr", std::make_unique<RepulsionRangeCommand>());
-        commandHandler_.registerCommand("p", std::make_unique<PauseCommand>());
-        commandHandler_.registerCommand("s", std::make_unique<StepCommand>());
-        commandHandler_.registerCommand("q", std::make_unique<ExitCommand>());
-
-        std::cout << PROMPT;
-    }
-    void InputHandler::pollInputs() const
-    {
-        if (!stdinHasData())
-            return;
-        std::string input;
-        if (!std::getline(std::cin, input)) {
-            exit(0);
-        }
-        if (input.empty()) {
-            std::cout << PROMPT;
-            return;
-        }
-        std::istringstream stream(input);
-        std::vector<std::string> args;
-        while (!stream.eof()) {
-            std::string arg;
-            stream >> arg;
-            if (!arg.empty())
-                args.push_back(std::move(arg));
-        }
-        commandHandler_.handleCommand(args);
-        std::cout << PROMPT;
-    }
+#include "InputHandler.h"
+#include <iostream>
+#include <sstream>
+namespace ParticleLife {
+    constexpr char PROMPT[] = "> ";
+    /// @brief separates commands of one batch sent by a control client
+    constexpr char COMMAND_SEPARATOR = ';';
+
+    InputHandler::InputHandler(Options& options, const Simulation& simulation, ControlServer& controlServer, const LoopMetrics& metrics) : commandHandler_(options, simulation), options_(options), simulation_(simulation), controlServer_(controlServer), metrics_(metrics) {}
+
+    //taken from https://stackoverflow.com/a/71992965
+#if defined(__GNUG__) || defined(__GNUC__)
+#define OS_LINUX
+#elif defined(_MAC)
+#define OS_MAC
+#elif defined(_WIN32)
+#define OS_WIN
+#endif
+#ifdef OS_WIN
+#include <conio.h>
+#elif defined(OS_LINUX) || defined(OS_MAC)
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+    bool InputHandler::stdinHasData() const
+    {
+#   if defined(OS_WIN)
+        // this works by harnessing Windows' black magic:
+        return _kbhit();
+#   elif defined(OS_LINUX) || defined(OS_MAC) 
+        // using a timeout of 0 so we aren't waiting:
+        struct timespec timeout { 0l, 0l };
+
+        // create a file descriptor set
+        fd_set fds{};
+
+        // initialize the fd_set to 0
+        FD_ZERO(&fds);
+        // set the fd_set to target file descriptor 0 (STDIN)
+        FD_SET(0, &fds);
+
+        // pselect the number of file descriptors that are ready, since
+        //  we're only passing in 1 file descriptor, it will return either
+        //  a 0 if STDIN isn't ready, or a 1 if it is.
+        return pselect(0 + 1, &fds, nullptr, nullptr, &timeout, nullptr) == 1;
+#   else
+        // throw a compiler error
+        static_assert(false, "Failed to detect a supported operating system!");
+#   endif
+    }
+
+    void InputHandler::init() {
+        commandHandler_.registerCommand("help", std::make_unique<HelpCommand>(commandHandler_.getCommands()));
+        commandHandler_.registerCommand("fps", std::make_unique<FPSCommand>());
+        commandHandler_.registerCommand("tps", std::make_unique<TPSCommand>());
+        commandHandler_.registerCommand("ts", std::make_unique<TimeStepCommand>());
+        commandHandler_.registerCommand("ss", std::make_unique<SimSpeedCommand>());
+        commandHandler_.registerCommand("ws", std::make_unique<WorldSizeCommand>());
+        commandHandler_.registerCommand("f", std::make_unique<FrictionCommand>());
+        commandHandler_.registerCommand("dr", std::make_unique<ParticleRadiusCommand>());
+        commandHandler_.registerCommand("dm", std::make_unique<DisplayModeCommand>());
+        commandHandler_.registerCommand("view", std::make_unique<ViewCommand>());
+        commandHandler_.registerCommand("smooth", std::make_unique<SmoothMotionCommand>());
+        commandHandler_.registerCommand("r", std::make_unique<RepulsionCommand>());
+        commandHandler_.registerCommand("law", std::make_unique<ForceLawCommand>());
+        commandHandler_.registerCommand("tf", std::make_unique<TabulatedForceCommand>());
+        commandHandler_.registerCommand("quiet", std::make_unique<QuiescenceCommand>(simulation_));
+        commandHandler_.registerCommand("cc", std::make_unique<ChunkCountCommand>());
+        commandHandler_.registerCommand("add", std::make_unique<AddSpeciesCommand>());
+        commandHandler_.registerCommand("sc", std::make_unique<ParticleCountCommand>());
+        commandHandler_.registerCommand("dc", std::make_unique<ColorCommand>());
+        commandHandler_.registerCommand("sa", std::make_unique<AttractionCommand>());
+        commandHandler_.registerCommand("sar", std::make_unique<AttractionRangeCommand>());
+        commandHandler_.registerCommand("srr", std::make_unique<RepulsionRangeCommand>());
+        commandHandler_.registerCommand("sweep", std::make_unique<SweepCommand>());
+        commandHandler_.registerCommand("sweepa", std::make_unique<AttractionSweepCommand>());
+        commandHandler_.registerCommand("export", std::make_unique<ExportCommand>());
+        commandHandler_.registerCommand("bench", std::make_unique<BenchmarkCommand>());
+        commandHandler_.registerCommand("obs", std::make_unique<ObservablesCommand>());
+        commandHandler_.registerCommand("shm", std::make_unique<SharedFramesCommand>());
+        commandHandler_.registerCommand("metrics", std::make_unique<MetricsCommand>(metrics_));
+        commandHandler_.registerCommand("clusters", std::make_unique<ClustersCommand>(simulation_));
+        commandHandler_.registerCommand("log", std::make_unique<LogCommand>(commandHandler_.getLog(), simulation_));
+        commandHandler_.registerCommand("replay", std::make_unique<ReplayCommand>(commandHandler_.getCommands()));
+        commandHandler_.registerCommand("control", std::make_unique<ControlCommand>(controlServer_));
+        commandHandler_.registerCommand("threads", std::make_unique<ThreadsCommand>());
+        commandHandler_.registerCommand("p", std::make_unique<PauseCommand>());
+        commandHandler_.registerCommand("s", std::make_unique<StepCommand>());
+        commandHandler_.registerCommand("q", std::make_unique<ExitCommand>());
+
+        std::cout << PROMPT;
+    }
+    std::vector<std::string> InputHandler::splitArguments(const std::string& line)
+    {
+        std::istringstream stream(line);
+        std::vector<std::string> args;
+        while (!stream.eof()) {
+            std::string arg;
+            stream >> arg;
+            if (!arg.empty())
+                args.push_back(std::move(arg));
+        }
+        return args;
+    }
+
+    void InputHandler::handleControlRequests()
+    {
+        for (auto&& request : controlServer_.takeRequests()) {
+            std::ostringstream response;
+            response << "{\"type\":\"result\",\"results\":[";
+            std::istringstream batch(request.line);
+            std::string command;
+            bool first = true;
+            while (std::getline(batch, command, COMMAND_SEPARATOR)) {
+                std::vector<std::string> args = splitArguments(command);
+                if (args.empty())
+                    continue;
+                command.erase(0, command.find_first_not_of(" \t"));
+                command.erase(command.find_last_not_of(" \t") + 1);
+                // the output meant for the console goes to the client instead
+                std::ostringstream output;
+                std::streambuf* console = std::cout.rdbuf(output.rdbuf());
+                bool succeeded = commandHandler_.handleCommand(args);
+                std::cout.rdbuf(console);
+                if (!first)
+                    response << ",";
+                first = false;
+                response << "{\"command\":\"" << ControlServer::escapeJson(command) << "\",\"ok\":" << (succeeded ? "true" : "false") << ",\"output\":\"" << ControlServer::escapeJson(output.str()) << "\"}";
+            }
+            response << "]}";
+            controlServer_.respond(request.client, response.str());
+        }
+    }
+
+    void InputHandler::pollInputs()
+    {
+        handleControlRequests();
+        if (!stdinHasData())
+            return;
+        std::string input;
+        if (!std::getline(std::cin, input)) {
+            exit(0);
+        }
+        if (input.empty()) {
+            std::cout << PROMPT;
+            return;
+        }
+        commandHandler_.handleCommand(splitArguments(input));
+        std::cout << PROMPT;
+    }
 }
\ No newline at end of file
@@ -1,21 +1,31 @@
-#ifndef INPUT_HANDLER_H
-#define INPUT_HANDLER_H
-#include "Options.h"
-#include "CommandHandler.h"
-namespace ParticleLife {
-    /// @brief reads user commands from stdin and hands them over to a CommandHandler to execute
-    class InputHandler {
-    private:
-        Options& options_;
-        CommandHandler commandHandler_;
-        /// @brief is stdin non-empty
-        bool stdinHasData() const;
-    public:
-        InputHandler(Options& options);
-        /// @brief register commands and prepare for user input
-        void init();
-        /// @brief check wheter input is ready an if so, handle it
-        void pollInputs() const;
-    };
-}
+#ifndef INPUT_HANDLER_H
+#define INPUT_HANDLER_H
+#include "Options.h"
+#include "Simulation.h"
+#include "CommandHandler.h"
+#include "ControlServer.h"
+#include "LoopMetrics.h"
+namespace ParticleLife {
+    /// @brief reads user commands from stdin and from control clients and hands them over to a CommandHandler to execute
+    class InputHandler {
+    private:
+        Options& options_;
+        const Simulation& simulation_;
+        ControlServer& controlServer_;
+        const LoopMetrics& metrics_;
+        CommandHandler commandHandler_;
+        /// @brief is stdin non-empty
+        bool stdinHasData() const;
+        /// @brief split a line into whitespace separated command name and arguments
+        static std::vector<std::string> splitArguments(const std::string& line);
+        /// @brief run batches of commands received by the control server and send back their results
+        void handleControlRequests();
+    public:
+        InputHandler(Options& options, const Simulation& simulation, ControlServer& controlServer, const LoopMetrics& metrics);
+        /// @brief register commands and prepare for user input
+        void init();
+        /// @brief check wheter input is ready an if so, handle it
+        void pollInputs();
+    };
+}
 #endif
\ No newline at end of file
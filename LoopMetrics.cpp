@@ -0,0 +1,90 @@
+#include "LoopMetrics.h"
+#include <bit>
+#include <cmath>
+#include <algorithm>
+namespace ParticleLife {
+    constexpr double NANOSECONDS_PER_MILLISECOND = 1000000.0;
+
+    LatencyHistogram::LatencyHistogram() : counts_(), sum_(0), max_(0) {}
+
+    size_t LatencyHistogram::getBucket(uint64_t nanoseconds)
+    {
+        if (nanoseconds < SUB_BUCKETS)
+            return (size_t)nanoseconds;
+        // keep the highest set bit and SUB_BUCKET_BITS bits below it
+        size_t shift = std::bit_width(nanoseconds) - SUB_BUCKET_BITS - 1;
+        return SUB_BUCKETS * (shift + 1) + (size_t)(nanoseconds >> shift) - SUB_BUCKETS;
+    }
+
+    uint64_t LatencyHistogram::getBucketEnd(size_t bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+        size_t shift = bucket / SUB_BUCKETS - 1;
+        uint64_t start = (uint64_t)(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+        return start + (((uint64_t)1 << shift) - 1);
+    }
+
+    void LatencyHistogram::record(double milliseconds)
+    {
+        uint64_t nanoseconds = (uint64_t)std::max(std::llround(milliseconds * NANOSECONDS_PER_MILLISECOND), 0ll);
+        // there is only one writer, so plain loads and stores suffice where read-modify-write operations would cost a locked instruction
+        std::atomic<uint64_t>& bucket = counts_[getBucket(nanoseconds)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum_.store(sum_.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+        if (nanoseconds > max_.load(std::memory_order_relaxed))
+            max_.store(nanoseconds, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram::Summary LatencyHistogram::summarize() const
+    {
+        // buckets are copied first, so that the percentiles come from one consistent set of counts even while latencies are being recorded
+        std::array<uint64_t, BUCKET_COUNT> counts;
+        uint64_t count = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++)
+        {
+            counts[i] = counts_[i].load(std::memory_order_relaxed);
+            count += counts[i];
+        }
+        Summary summary{ count, 0, 0, 0, 0, 0 };
+        if (count == 0)
+            return summary;
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        summary.mean = (double)sum_.load(std::memory_order_relaxed) / count / NANOSECONDS_PER_MILLISECOND;
+        summary.max = max / NANOSECONDS_PER_MILLISECOND;
+        auto percentile = [&](double fraction) {
+            uint64_t rank = std::max((uint64_t)std::ceil(fraction * count), (uint64_t)1);
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKET_COUNT; i++)
+            {
+                seen += counts[i];
+                if (seen >= rank)
+                    return std::min(getBucketEnd(i), max) / NANOSECONDS_PER_MILLISECOND;
+            }
+            return summary.max;
+        };
+        summary.p50 = percentile(0.5);
+        summary.p90 = percentile(0.9);
+        summary.p99 = percentile(0.99);
+        return summary;
+    }
+
+    LoopMetrics::LoopMetrics() : tickDurations(), tickIntervals(), frameDurations(), frameIntervals(), droppedTicks(0), droppedFrames(0) {}
+
+    void LoopMetrics::write(std::ostream& out, double targetTickInterval, double targetFrameInterval) const
+    {
+        auto writeHistogram = [&out](const char* name, const LatencyHistogram& histogram) {
+            LatencyHistogram::Summary summary = histogram.summarize();
+            out << name << "\t" << summary.count << "\t" << summary.mean << "\t" << summary.p50 << "\t" << summary.p90 << "\t" << summary.p99 << "\t" << summary.max << std::endl;
+        };
+        out << "metric\tcount\tmean ms\tp50 ms\tp90 ms\tp99 ms\tmax ms" << std::endl;
+        writeHistogram("tick duration", tickDurations);
+        writeHistogram("tick interval", tickIntervals);
+        writeHistogram("frame duration", frameDurations);
+        writeHistogram("frame interval", frameIntervals);
+        out << "target tick interval ms\t" << targetTickInterval << std::endl;
+        out << "target frame interval ms\t" << targetFrameInterval << std::endl;
+        out << "dropped ticks\t" << droppedTicks.load(std::memory_order_relaxed) << std::endl;
+        out << "dropped frames\t" << droppedFrames.load(std::memory_order_relaxed) << std::endl;
+    }
+}
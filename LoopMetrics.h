@@ -0,0 +1,65 @@
+#ifndef LOOP_METRICS_H
+#define LOOP_METRICS_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+namespace ParticleLife {
+    /// @brief distribution of latencies in buckets of roughly 6 % width, from 1 ns up, cheap enough to record every tick
+    /// @details values are recorded by a single thread, any thread can read them at the same time without locks
+    class LatencyHistogram {
+    public:
+        /// @brief bits of a value kept below its highest set bit, each power of two is split into 2^SUB_BUCKET_BITS buckets
+        static constexpr size_t SUB_BUCKET_BITS = 4;
+        static constexpr size_t SUB_BUCKETS = (size_t)1 << SUB_BUCKET_BITS;
+        static constexpr size_t BUCKET_COUNT = SUB_BUCKETS * (64 - SUB_BUCKET_BITS + 1);
+
+        /// @brief percentiles of the recorded latencies in milliseconds, each the upper bound of its bucket
+        struct Summary {
+            uint64_t count;
+            double mean;
+            double p50;
+            double p90;
+            double p99;
+            double max;
+        };
+    private:
+        /// @brief number of latencies in each bucket, in nanoseconds
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts_;
+        /// @brief sum of all latencies in nanoseconds
+        std::atomic<uint64_t> sum_;
+        /// @brief longest latency in nanoseconds
+        std::atomic<uint64_t> max_;
+        /// @brief index of the bucket containing a value
+        static size_t getBucket(uint64_t nanoseconds);
+        /// @brief largest value of a bucket
+        static uint64_t getBucketEnd(size_t bucket);
+    public:
+        LatencyHistogram();
+        /// @brief add a latency, only one thread may call it
+        void record(double milliseconds);
+        Summary summarize() const;
+    };
+
+    /// @brief latencies and schedule misses of the main loop
+    struct LoopMetrics {
+        /// @brief time spent simulating each tick
+        LatencyHistogram tickDurations;
+        /// @brief time between starts of consecutive ticks while the simulation runs
+        LatencyHistogram tickIntervals;
+        /// @brief time spent rendering each frame
+        LatencyHistogram frameDurations;
+        /// @brief time between starts of consecutive frames
+        LatencyHistogram frameIntervals;
+        /// @brief ticks skipped because the simulation fell too far behind schedule
+        std::atomic<uint64_t> droppedTicks;
+        /// @brief frames skipped because rendering fell too far behind schedule
+        std::atomic<uint64_t> droppedFrames;
+        LoopMetrics();
+        /// @brief write all metrics as tab separated text
+        /// @param targetTickInterval planned time between ticks in milliseconds
+        /// @param targetFrameInterval planned time between frames in milliseconds
+        void write(std::ostream& out, double targetTickInterval, double targetFrameInterval) const;
+    };
+}
+#endif
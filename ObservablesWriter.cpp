@@ -0,0 +1,175 @@
+#include "ObservablesWriter.h"
+#include <filesystem>
+#include <numbers>
+#include <cstdint>
+namespace ParticleLife {
+    /// @brief maximum number of observables waiting to be written
+    constexpr size_t MAX_QUEUED_OBSERVABLES = 1024;
+    constexpr char BINARY_EXTENSION[] = ".bin";
+    constexpr char CSV_HEADER[] = "time,quantity,species,other species,bin,value";
+
+    void TickObservables::reset(size_t count)
+    {
+        speciesCount = count;
+        particleCounts.assign(count, 0);
+        kineticEnergy.assign(count, 0);
+        attractionRanges.assign(count * count, 0);
+        repulsionPairs.assign(count * count, 0);
+        attractionPairs.assign(count * count, 0);
+        distanceCounts.assign(count * count * DISTANCE_BINS, 0);
+    }
+
+    void TickObservables::add(const TickObservables& other)
+    {
+        for (size_t s = 0; s < speciesCount; s++)
+        {
+            particleCounts[s] += other.particleCounts[s];
+            kineticEnergy[s] += other.kineticEnergy[s];
+        }
+        for (size_t p = 0; p < speciesCount * speciesCount; p++)
+        {
+            repulsionPairs[p] += other.repulsionPairs[p];
+            attractionPairs[p] += other.attractionPairs[p];
+        }
+        for (size_t i = 0; i < distanceCounts.size(); i++)
+        {
+            distanceCounts[i] += other.distanceCounts[i];
+        }
+    }
+
+    double TickObservables::getRadialDistribution(size_t species, size_t otherSpecies, size_t bin) const
+    {
+        size_t pair = species * speciesCount + otherSpecies;
+        double binWidth = attractionRanges[pair] / DISTANCE_BINS;
+        double shellArea = std::numbers::pi * binWidth * binWidth * ((bin + 1) * (bin + 1) - bin * bin);
+        double otherDensity = particleCounts[otherSpecies] / ((double)worldSize * worldSize);
+        double expected = particleCounts[species] * otherDensity * shellArea;
+        return expected == 0 ? 0 : distanceCounts[pair * DISTANCE_BINS + bin] / expected;
+    }
+
+    ObservablesWriter::ObservablesWriter() : path_(), binary_(false), file_(), thread_(), mutex_(), queued_(), queue_(), closing_(false) {}
+
+    ObservablesWriter::~ObservablesWriter()
+    {
+        close();
+    }
+
+    bool ObservablesWriter::open(const std::string& path)
+    {
+        close();
+        if (path.empty())
+            return true;
+        binary_ = std::filesystem::path(path).extension() == BINARY_EXTENSION;
+        file_.open(path, binary_ ? std::ios::binary : std::ios::out);
+        if (!file_)
+            return false;
+        if (!binary_)
+            file_ << CSV_HEADER << std::endl;
+        path_ = path;
+        closing_ = false;
+        thread_ = std::thread(&ObservablesWriter::work, this);
+        return true;
+    }
+
+    void ObservablesWriter::close()
+    {
+        if (thread_.joinable()) {
+            {
+                std::lock_guard lock(mutex_);
+                closing_ = true;
+            }
+            queued_.notify_one();
+            thread_.join();
+        }
+        file_.close();
+        path_.clear();
+    }
+
+    void ObservablesWriter::submit(TickObservables&& observables)
+    {
+        if (path_.empty())
+            return;
+        {
+            std::lock_guard lock(mutex_);
+            if (queue_.size() >= MAX_QUEUED_OBSERVABLES)
+                queue_.pop_front();
+            queue_.push_back(std::move(observables));
+        }
+        queued_.notify_one();
+    }
+
+    void ObservablesWriter::work()
+    {
+        while (true) {
+            TickObservables observables;
+            bool drained;
+            {
+                std::unique_lock lock(mutex_);
+                queued_.wait(lock, [this] { return closing_ || !queue_.empty(); });
+                if (queue_.empty())
+                    break;
+                observables = std::move(queue_.front());
+                queue_.pop_front();
+                drained = queue_.empty();
+            }
+            if (binary_)
+                writeBinary(observables);
+            else
+                writeCsv(observables);
+            // the program may exit without closing the writer, so whatever has been measured so far is kept on disk
+            if (drained)
+                file_.flush();
+        }
+        file_.flush();
+    }
+
+    void ObservablesWriter::writeCsv(const TickObservables& observables)
+    {
+        size_t count = observables.speciesCount;
+        for (size_t s = 0; s < count; s++)
+        {
+            file_ << observables.time << ",kinetic energy," << s << ",,," << observables.kineticEnergy[s] << "\n";
+        }
+        for (size_t s = 0; s < count; s++)
+        {
+            for (size_t os = 0; os < count; os++)
+            {
+                size_t pair = s * count + os;
+                size_t pairs = observables.repulsionPairs[pair] + observables.attractionPairs[pair];
+                file_ << observables.time << ",repulsed fraction," << s << "," << os << ",," << (pairs == 0 ? 0 : (double)observables.repulsionPairs[pair] / pairs) << "\n";
+                for (size_t b = 0; b < TickObservables::DISTANCE_BINS; b++)
+                {
+                    file_ << observables.time << ",radial distribution," << s << "," << os << "," << b << "," << observables.getRadialDistribution(s, os, b) << "\n";
+                }
+            }
+        }
+    }
+
+    void ObservablesWriter::writeBinary(const TickObservables& observables)
+    {
+        // record: time, species count, kinetic energy of each species, repulsed fraction of each pair, radial distribution of each pair and bin, all as 64 bit values
+        auto write = [this](auto value) { file_.write((const char*)&value, sizeof(value)); };
+        size_t count = observables.speciesCount;
+        write(observables.time);
+        write((uint64_t)count);
+        for (size_t s = 0; s < count; s++)
+        {
+            write(observables.kineticEnergy[s]);
+        }
+        for (size_t pair = 0; pair < count * count; pair++)
+        {
+            size_t pairs = observables.repulsionPairs[pair] + observables.attractionPairs[pair];
+            write(pairs == 0 ? 0.0 : (double)observables.repulsionPairs[pair] / pairs);
+        }
+        for (size_t s = 0; s < count; s++)
+        {
+            for (size_t os = 0; os < count; os++)
+            {
+                for (size_t b = 0; b < TickObservables::DISTANCE_BINS; b++)
+                {
+                    write(observables.getRadialDistribution(s, os, b));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef OBSERVABLES_WRITER_H
+#define OBSERVABLES_WRITER_H
+#include <vector>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+namespace ParticleLife {
+    /// @brief quantities measured during one tick, collected by the force and position passes
+    struct TickObservables {
+        /// @brief number of distance bins of the radial distribution of each species pair
+        static constexpr size_t DISTANCE_BINS = 16;
+        /// @brief simulated time
+        double time;
+        float worldSize;
+        size_t speciesCount;
+        /// @brief number of particles of each species
+        std::vector<size_t> particleCounts;
+        /// @brief sum of squared velocities halved of each species
+        std::vector<double> kineticEnergy;
+        /// @brief attraction range of each species pair, indexed by species * species count + other species
+        std::vector<float> attractionRanges;
+        /// @brief number of pairs closer than their repulsion range, of each species pair
+        std::vector<size_t> repulsionPairs;
+        /// @brief number of pairs within attraction range but not repulsion range, of each species pair
+        std::vector<size_t> attractionPairs;
+        /// @brief number of pairs at each distance, DISTANCE_BINS equal bins from 0 to attraction range of each species pair
+        std::vector<size_t> distanceCounts;
+        /// @brief set all counters to zero
+        void reset(size_t speciesCount);
+        /// @brief add counters of other observables
+        void add(const TickObservables& other);
+        /// @brief count a pair of particles within attraction range
+        /// @param pair species * species count + other species
+        /// @param repulsed is the pair closer than its repulsion range
+        /// @param relativeDistance distance divided by attraction range
+        inline void addPair(size_t pair, bool repulsed, float relativeDistance) {
+            if (repulsed)
+                repulsionPairs[pair]++;
+            else
+                attractionPairs[pair]++;
+            distanceCounts[pair * DISTANCE_BINS + std::min((size_t)(relativeDistance * DISTANCE_BINS), DISTANCE_BINS - 1)]++;
+        }
+        /// @brief get the radial distribution function of a species pair in given bin, 1 for uniformly spread particles
+        double getRadialDistribution(size_t species, size_t otherSpecies, size_t bin) const;
+    };
+
+    /// @brief writes observables into a file on a background thread, as CSV or as binary records if the file name ends with ".bin"
+    class ObservablesWriter {
+    private:
+        std::string path_;
+        bool binary_;
+        std::ofstream file_;
+        std::thread thread_;
+        std::mutex mutex_;
+        /// @brief signals new observables in the queue or closing
+        std::condition_variable queued_;
+        std::deque<TickObservables> queue_;
+        bool closing_;
+        /// @brief loop of the writing thread
+        void work();
+        void writeCsv(const TickObservables& observables);
+        void writeBinary(const TickObservables& observables);
+    public:
+        ObservablesWriter();
+        ~ObservablesWriter();
+        ObservablesWriter(const ObservablesWriter&) = delete;
+        ObservablesWriter& operator=(const ObservablesWriter&) = delete;
+        /// @brief close the current file and start writing into another one, empty path only closes it
+        /// @return could the file be opened
+        bool open(const std::string& path);
+        /// @brief write all queued observables and close the file
+        void close();
+        /// @brief get path of the open file, empty if there is none
+        inline const std::string& getPath() const { return path_; }
+        /// @brief queue observables to be written, never waits for the file, the oldest ones are dropped if the queue is full
+        void submit(TickObservables&& observables);
+    };
+}
+#endif
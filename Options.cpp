@@ -1,223 +1,387 @@
-#include "Options.h"
-namespace ParticleLife {
-    const sf::Color* DEFAULT_COLORS[] = { &sf::Color::Green, &sf::Color::Red, &sf::Color::Blue, &sf::Color::Yellow, &sf::Color::White, &sf::Color::Magenta, &sf::Color::Cyan };
-    const size_t DEFAULT_COLORS_AMT = sizeof(DEFAULT_COLORS) / sizeof(*DEFAULT_COLORS);
-    constexpr int MAIN_COLOR_MIN_VALUE = 60;
-    constexpr int MAX_COLOR_VALUE = 255;
-
-    constexpr float DEFAULT_MAX_ATTRACTION_MAGNITUDE = 8;
-    constexpr float DEFAULT_MAX_ATTRACTION_RANGE = 8;
-    constexpr float DEFAULT_MIN_REPULSION_RANGE = 0.5;
-    constexpr float DEFAULT_MAX_REPULSION_RANGE = 1.5;
-
-    constexpr size_t DEFAULT_SPECIES_COUNT = 8;
-    constexpr size_t DEFAULT_PARTICLE_COUNT = 120;
-
-    Options::Options() :
-        frameTime_(1 / 60.0f), timeStep_(1 / 60.0f), simSpeed_(1), realTimeStep_(timeStep_ / simSpeed_), worldSize_(100), friction_(0.25f), frictionMultiplierPerTick_(std::powf(friction_, timeStep_)),
-        particleRadius_(0.3f), repulsion_(200), chunkCount_(16), chunkSize_(worldSize_ / chunkCount_), maxChunkRange_(), species_(), chunkPattern_(), random(time(nullptr)), paused(false), step(false)
-    {
-        for (size_t i = 0; i < DEFAULT_SPECIES_COUNT; i++)
-        {
-            addRandomSpecies(DEFAULT_PARTICLE_COUNT);
-        }
-        recalculateChunks();
-    }
-
-    void Options::setFPS(float fps) {
-        frameTime_ = 1 / fps;
-    }
-    float Options::getFrameTime() const {
-        return frameTime_;
-    }
-    void Options::setTimeStep(float timeStep) {
-        timeStep_ = timeStep;
-        realTimeStep_ = timeStep_ / simSpeed_;
-    }
-    float Options::getTimeStep() const {
-        return timeStep_;
-    }
-    void Options::setSimulationSpeed(float simulationSpeed) {
-        simSpeed_ = simulationSpeed;
-        realTimeStep_ = timeStep_ / simSpeed_;
-    }
-    float Options::getSimulationSpeed() const {
-        return simSpeed_;
-    }
-    float Options::getRealTimeStep() const {
-        return realTimeStep_;
-    }
-    void Options::setWorldSize(float worldSize) {
-        worldSize_ = worldSize;
-        chunkSize_ = worldSize / chunkCount_;
-        recalculateChunks();
-    }
-    float Options::getWorldSize() const {
-        return worldSize_;
-    }
-    void Options::setFriction(float coefficient) {
-        friction_ = coefficient;
-        frictionMultiplierPerTick_ = std::powf(friction_, timeStep_);
-    }
-    float Options::getFriction() const {
-        return friction_;
-    }
-    float Options::getFrictionMultiplierPerTick() const {
-        return frictionMultiplierPerTick_;
-    }
-    void Options::setParticleRadius(float particleRadius) {
-        particleRadius_ = particleRadius;
-    }
-    float Options::getParticleRadius() const {
-        return particleRadius_;
-    }
-    void Options::setRepulsion(float repulsion) {
-        repulsion_ = repulsion;
-    }
-    float Options::getRepulsion() const {
-        return repulsion_;
-    }
-    void Options::setChunkCount(size_t count) {
-        chunkCount_ = count;
-        chunkSize_ = worldSize_ / count;
-        recalculateChunks();
-    }
-    size_t Options::getChunkCount() const {
-        return chunkCount_;
-    }
-    float Options::getChunkSize() const {
-        return chunkSize_;
-    }
-
-    void Options::recalculateChunks() {
-        float prevChunkRange = maxChunkRange_;
-        for (auto&& s : species_) {
-            for (auto&& r : s.attractionRange) {
-                float chunkRange = r / chunkSize_;
-                if (chunkRange > maxChunkRange_)
-                    maxChunkRange_ = chunkRange;
-            }
-        }
-        if (maxChunkRange_ > prevChunkRange)
-            recalculateChunkPattern();
-        recalculateChunkRanges();
-    }
-    void Options::recalculateChunkPattern() {
-        chunkPattern_ = {};
-        size_t ceilRange = std::ceilf(maxChunkRange_);
-        for (unsigned int x = 1; x <= ceilRange; x++)
-        {
-            for (unsigned int y = 0; y <= ceilRange; y++)
-            {
-                chunkPattern_.emplace_back(x, y);
-            }
-        }
-        std::sort(chunkPattern_.begin(), chunkPattern_.end(), chunkDistanceComparer());
-        float maxRangeSquared = maxChunkRange_ * maxChunkRange_;
-        chunkDistanceSquared distSq = {};
-        size_t i = 0;
-        for (auto&& e : chunkPattern_)
-        {
-            if (distSq(e) >= maxRangeSquared)
-                break;
-            i++;
-        }
-        chunkPattern_.resize(i);
-    }
-    void Options::recalculateChunkRanges() {
-        chunkDistanceSquared distSq = {};
-        std::vector<size_t> distsSq = {};
-        for (auto&& e : chunkPattern_)
-        {
-            distsSq.push_back(distSq(e));
-        }
-        float chunkSqMultiplier = 1 / (chunkSize_ * chunkSize_);
-        for (auto&& s : species_) {
-            s.chunkRange.resize(s.attractionRange.size());
-            for (size_t i = 0; i < s.attractionRange.size(); i++)
-            {
-                float rangeSq = s.attractionRange[i] * s.attractionRange[i] * chunkSqMultiplier;
-                size_t r = 0;
-                for (auto&& d : distsSq)
-                {
-                    if (d >= rangeSq)
-                        break;
-                    r++;
-                }
-                s.chunkRange[i] = r;
-            }
-        }
-    }
-    size_t Options::chunkDistanceSquared::operator()(sf::Vector2u chunkPos) {
-        size_t x = chunkPos.x - 1;
-        if (chunkPos.y == 0)
-            return x * x;
-        size_t y = chunkPos.y - 1;
-        return x * x + y * y;
-    }
-    bool Options::chunkDistanceComparer::operator()(sf::Vector2u a, sf::Vector2u b) {
-        chunkDistanceSquared c = {};
-        return c(a) < c(b);
-    }
-
-    void Options::addRandomSpecies(size_t particleCount) {
-        std::uniform_real_distribution<float> attractionDistribution(-DEFAULT_MAX_ATTRACTION_MAGNITUDE, DEFAULT_MAX_ATTRACTION_MAGNITUDE);
-        std::uniform_real_distribution<float> repulsionRangeDistribution(DEFAULT_MIN_REPULSION_RANGE, DEFAULT_MAX_REPULSION_RANGE);
-        std::uniform_real_distribution<float> attractionRangeDistribution(DEFAULT_MAX_REPULSION_RANGE, DEFAULT_MAX_ATTRACTION_RANGE);
-        sf::Color color = species_.size() < DEFAULT_COLORS_AMT ? *DEFAULT_COLORS[species_.size()] : getRandomColor();
-        ParticleSpecies s = ParticleSpecies(species_.size(), color, particleCount);
-        for (size_t i = 0; i < species_.size() + 1; i++)
-        {
-            s.attraction.push_back(attractionDistribution(random));
-            s.repulsionRange.push_back(repulsionRangeDistribution(random));
-            s.attractionRange.push_back(attractionRangeDistribution(random));
-        }
-        for (auto&& sp : species_) {
-            sp.attraction.push_back(attractionDistribution(random));
-            sp.repulsionRange.push_back(repulsionRangeDistribution(random));
-            sp.attractionRange.push_back(attractionRangeDistribution(random));
-        }
-        species_.push_back(s);
-        recalculateChunks();
-    }
-
-    sf::Color Options::getRandomColor() {
-        std::uniform_int_distribution<size_t> mainColorDist(MAIN_COLOR_MIN_VALUE, MAX_COLOR_VALUE);
-        std::uniform_int_distribution<size_t> auxColorDist(0, MAX_COLOR_VALUE);
-        std::uniform_int_distribution<size_t> selectorDist(0, 2);
-        size_t selector = selectorDist(random);
-        return sf::Color(
-            selector == 0 ? mainColorDist(random) : auxColorDist(random),
-            selector == 1 ? mainColorDist(random) : auxColorDist(random),
-            selector == 2 ? mainColorDist(random) : auxColorDist(random)
-        );
-    }
-
-    size_t Options::getSpeciesCount() const {
-        return species_.size();
-    }
-    const ParticleSpecies& Options::getSpecies(size_t id) const {
-        return species_[id];
-    }
-    void Options::setParticleCount(size_t id, size_t count) {
-        species_[id].count = count;
-    }
-    void Options::setSpeciesColor(size_t id, sf::Color color) {
-        species_[id].color = color;
-    }
-    void Options::setSpeciesAttraction(size_t id, size_t other, float attraction) {
-        species_[id].attraction[other] = attraction;
-    }
-    void Options::setSpeciesAttractionRange(size_t id, size_t other, float range) {
-        species_[id].attractionRange[other] = range;
-        recalculateChunks();
-    }
-    void Options::setSpeciesRepulsionRange(size_t id, size_t other, float range) {
-        species_[id].repulsionRange[other] = range;
-        recalculateChunks();
-    }
-    const std::vector<sf::Vector2u>& Options::getChunkPattern() const
-    {
-        return chunkPattern_;
-    }
+#include "Options.h"
+#include <algorithm>
+#include <cmath>
+namespace ParticleLife {
+    const sf::Color* DEFAULT_COLORS[] = { &sf::Color::Green, &sf::Color::Red, &sf::Color::Blue, &sf::Color::Yellow, &sf::Color::White, &sf::Color::Magenta, &sf::Color::Cyan };
+    const size_t DEFAULT_COLORS_AMT = sizeof(DEFAULT_COLORS) / sizeof(*DEFAULT_COLORS);
+    constexpr int MAIN_COLOR_MIN_VALUE = 60;
+    constexpr int MAX_COLOR_VALUE = 255;
+
+    constexpr float DEFAULT_MAX_ATTRACTION_MAGNITUDE = 8;
+    constexpr float DEFAULT_MIN_REPULSION_RANGE = 0.5;
+    constexpr float DEFAULT_MAX_REPULSION_RANGE = 1.5;
+
+    constexpr size_t DEFAULT_SPECIES_COUNT = 8;
+    constexpr size_t DEFAULT_PARTICLE_COUNT = 120;
+
+    Options::Options() : Options(time(nullptr)) {}
+
+    Options::Options(uint64_t seed) :
+        frameTime_(1 / 60.0f), timeStep_(1 / 60.0f), simSpeed_(1), realTimeStep_(timeStep_ / simSpeed_), worldSize_(100), friction_(0.25f), frictionMultiplierPerTick_(std::powf(friction_, timeStep_)),
+        particleRadius_(0.3f), displayMode_(DisplayMode::Particles), viewZoom_(1), viewCenter_(0.5f, 0.5f), smoothMotion_(true), repulsion_(200), forceLaw_(ForceLaw::PiecewiseLinear), tabulatedForces_(false), chunkCount_(16), chunkSize_(worldSize_ / chunkCount_), maxChunkRange_(), species_(), chunkPattern_(), parallel_(true), seed_(seed), reordering_(true), threadCount_(0), threadPlacement_(ThreadPlacement::Free), clusterLinkingDistance_(1), clusterInterval_(0), clusterChunkRange_(0), observablesInterval_(0), observablesFile_(), sharedFramesInterval_(0), sharedFramesName_(), quiescenceDistance_(0), quiescenceTicks_(10), quiescenceRefreshInterval_(100), parametersVersion_(0), parameters_(), random(seed_), paused(false), step(false)
+    {
+        for (size_t i = 0; i < DEFAULT_SPECIES_COUNT; i++)
+        {
+            addRandomSpecies(DEFAULT_PARTICLE_COUNT);
+        }
+        recalculateChunks();
+        publishParameters();
+    }
+
+    void Options::setFPS(float fps) {
+        frameTime_ = 1 / fps;
+    }
+    float Options::getFrameTime() const {
+        return frameTime_;
+    }
+    void Options::setTimeStep(float timeStep) {
+        timeStep_ = timeStep;
+        realTimeStep_ = timeStep_ / simSpeed_;
+        publishParameters();
+    }
+    float Options::getTimeStep() const {
+        return timeStep_;
+    }
+    void Options::setSimulationSpeed(float simulationSpeed) {
+        simSpeed_ = simulationSpeed;
+        realTimeStep_ = timeStep_ / simSpeed_;
+    }
+    float Options::getSimulationSpeed() const {
+        return simSpeed_;
+    }
+    float Options::getRealTimeStep() const {
+        return realTimeStep_;
+    }
+    void Options::setWorldSize(float worldSize) {
+        worldSize_ = worldSize;
+        chunkSize_ = worldSize / chunkCount_;
+        recalculateChunks();
+        publishParameters();
+    }
+    float Options::getWorldSize() const {
+        return worldSize_;
+    }
+    void Options::setFriction(float coefficient) {
+        friction_ = coefficient;
+        frictionMultiplierPerTick_ = std::powf(friction_, timeStep_);
+        publishParameters();
+    }
+    float Options::getFriction() const {
+        return friction_;
+    }
+    float Options::getFrictionMultiplierPerTick() const {
+        return frictionMultiplierPerTick_;
+    }
+    void Options::setParticleRadius(float particleRadius) {
+        particleRadius_ = particleRadius;
+    }
+    float Options::getParticleRadius() const {
+        return particleRadius_;
+    }
+    void Options::setDisplayMode(DisplayMode displayMode) {
+        displayMode_ = displayMode;
+    }
+    DisplayMode Options::getDisplayMode() const {
+        return displayMode_;
+    }
+    void Options::setView(float zoom, sf::Vector2f center) {
+        viewZoom_ = std::clamp(zoom, 1.0f, MAX_VIEW_ZOOM);
+        // stored relative to the world, so that the same part stays in view when the world is resized
+        viewCenter_.x = center.x / worldSize_ - std::floor(center.x / worldSize_);
+        viewCenter_.y = center.y / worldSize_ - std::floor(center.y / worldSize_);
+    }
+    float Options::getViewZoom() const {
+        return viewZoom_;
+    }
+    sf::Vector2f Options::getViewCenter() const {
+        return viewCenter_ * worldSize_;
+    }
+    void Options::setSmoothMotion(bool smooth) {
+        smoothMotion_ = smooth;
+    }
+    bool Options::isSmoothMotion() const {
+        return smoothMotion_;
+    }
+    void Options::setRepulsion(float repulsion) {
+        repulsion_ = repulsion;
+        publishParameters();
+    }
+    float Options::getRepulsion() const {
+        return repulsion_;
+    }
+    void Options::setForceLaw(ForceLaw forceLaw) {
+        forceLaw_ = forceLaw;
+        publishParameters();
+    }
+    ForceLaw Options::getForceLaw() const {
+        return forceLaw_;
+    }
+    void Options::setTabulatedForces(bool tabulated) {
+        tabulatedForces_ = tabulated;
+        publishParameters();
+    }
+    bool Options::isTabulatedForces() const {
+        return tabulatedForces_;
+    }
+    void Options::setChunkCount(size_t count) {
+        chunkCount_ = count;
+        chunkSize_ = worldSize_ / count;
+        recalculateChunks();
+        publishParameters();
+    }
+    size_t Options::getChunkCount() const {
+        return chunkCount_;
+    }
+    float Options::getChunkSize() const {
+        return chunkSize_;
+    }
+
+    void Options::recalculateChunks() {
+        float prevChunkRange = maxChunkRange_;
+        for (auto&& s : species_) {
+            for (auto&& r : s.attractionRange) {
+                float chunkRange = r / chunkSize_;
+                if (chunkRange > maxChunkRange_)
+                    maxChunkRange_ = chunkRange;
+            }
+        }
+        if (maxChunkRange_ > prevChunkRange)
+            recalculateChunkPattern();
+        recalculateChunkRanges();
+    }
+    void Options::recalculateChunkPattern() {
+        chunkPattern_ = {};
+        size_t ceilRange = std::ceilf(maxChunkRange_);
+        for (unsigned int x = 1; x <= ceilRange; x++)
+        {
+            for (unsigned int y = 0; y <= ceilRange; y++)
+            {
+                chunkPattern_.emplace_back(x, y);
+            }
+        }
+        std::sort(chunkPattern_.begin(), chunkPattern_.end(), chunkDistanceComparer());
+        float maxRangeSquared = maxChunkRange_ * maxChunkRange_;
+        chunkDistanceSquared distSq = {};
+        size_t i = 0;
+        for (auto&& e : chunkPattern_)
+        {
+            if (distSq(e) >= maxRangeSquared)
+                break;
+            i++;
+        }
+        chunkPattern_.resize(i);
+    }
+    void Options::recalculateChunkRanges() {
+        chunkDistanceSquared distSq = {};
+        std::vector<size_t> distsSq = {};
+        for (auto&& e : chunkPattern_)
+        {
+            distsSq.push_back(distSq(e));
+        }
+        for (auto&& s : species_) {
+            s.chunkRange.resize(s.attractionRange.size());
+            for (size_t i = 0; i < s.attractionRange.size(); i++)
+            {
+                s.chunkRange[i] = getChunkRange(distsSq, s.attractionRange[i]);
+            }
+        }
+        clusterChunkRange_ = getChunkRange(distsSq, clusterLinkingDistance_);
+    }
+    size_t Options::getChunkRange(const std::vector<size_t>& distancesSquared, float range) const {
+        float rangeSq = range * range / (chunkSize_ * chunkSize_);
+        size_t r = 0;
+        for (auto&& d : distancesSquared)
+        {
+            if (d >= rangeSq)
+                break;
+            r++;
+        }
+        return r;
+    }
+    size_t Options::chunkDistanceSquared::operator()(sf::Vector2u chunkPos) {
+        size_t x = chunkPos.x - 1;
+        if (chunkPos.y == 0)
+            return x * x;
+        size_t y = chunkPos.y - 1;
+        return x * x + y * y;
+    }
+    bool Options::chunkDistanceComparer::operator()(sf::Vector2u a, sf::Vector2u b) {
+        chunkDistanceSquared c = {};
+        return c(a) < c(b);
+    }
+
+    void Options::addRandomSpecies(size_t particleCount) {
+        std::uniform_real_distribution<float> attractionDistribution(-DEFAULT_MAX_ATTRACTION_MAGNITUDE, DEFAULT_MAX_ATTRACTION_MAGNITUDE);
+        std::uniform_real_distribution<float> repulsionRangeDistribution(DEFAULT_MIN_REPULSION_RANGE, DEFAULT_MAX_REPULSION_RANGE);
+        std::uniform_real_distribution<float> attractionRangeDistribution(DEFAULT_MAX_REPULSION_RANGE, MAX_RANDOM_ATTRACTION_RANGE);
+        sf::Color color = species_.size() < DEFAULT_COLORS_AMT ? *DEFAULT_COLORS[species_.size()] : getRandomColor();
+        ParticleSpecies s = ParticleSpecies(species_.size(), color, particleCount);
+        for (size_t i = 0; i < species_.size() + 1; i++)
+        {
+            s.attraction.push_back(attractionDistribution(random));
+            s.repulsionRange.push_back(repulsionRangeDistribution(random));
+            s.attractionRange.push_back(attractionRangeDistribution(random));
+        }
+        for (auto&& sp : species_) {
+            sp.attraction.push_back(attractionDistribution(random));
+            sp.repulsionRange.push_back(repulsionRangeDistribution(random));
+            sp.attractionRange.push_back(attractionRangeDistribution(random));
+        }
+        species_.push_back(s);
+        recalculateChunks();
+        publishParameters();
+    }
+
+    void Options::randomizeInteractions() {
+        std::uniform_real_distribution<float> attractionDistribution(-DEFAULT_MAX_ATTRACTION_MAGNITUDE, DEFAULT_MAX_ATTRACTION_MAGNITUDE);
+        std::uniform_real_distribution<float> repulsionRangeDistribution(DEFAULT_MIN_REPULSION_RANGE, DEFAULT_MAX_REPULSION_RANGE);
+        std::uniform_real_distribution<float> attractionRangeDistribution(DEFAULT_MAX_REPULSION_RANGE, MAX_RANDOM_ATTRACTION_RANGE);
+        for (auto&& s : species_) {
+            for (size_t i = 0; i < species_.size(); i++)
+            {
+                s.attraction[i] = attractionDistribution(random);
+                s.repulsionRange[i] = repulsionRangeDistribution(random);
+                s.attractionRange[i] = attractionRangeDistribution(random);
+            }
+        }
+        recalculateChunks();
+        publishParameters();
+    }
+
+    sf::Color Options::getRandomColor() {
+        std::uniform_int_distribution<size_t> mainColorDist(MAIN_COLOR_MIN_VALUE, MAX_COLOR_VALUE);
+        std::uniform_int_distribution<size_t> auxColorDist(0, MAX_COLOR_VALUE);
+        std::uniform_int_distribution<size_t> selectorDist(0, 2);
+        size_t selector = selectorDist(random);
+        return sf::Color(
+            selector == 0 ? mainColorDist(random) : auxColorDist(random),
+            selector == 1 ? mainColorDist(random) : auxColorDist(random),
+            selector == 2 ? mainColorDist(random) : auxColorDist(random)
+        );
+    }
+
+    size_t Options::getSpeciesCount() const {
+        return species_.size();
+    }
+    const ParticleSpecies& Options::getSpecies(size_t id) const {
+        return species_[id];
+    }
+    void Options::setParticleCount(size_t id, size_t count) {
+        species_[id].count = count;
+        publishParameters();
+    }
+    void Options::setSpeciesColor(size_t id, sf::Color color) {
+        species_[id].color = color;
+    }
+    void Options::setSpeciesAttraction(size_t id, size_t other, float attraction) {
+        species_[id].attraction[other] = attraction;
+        publishParameters();
+    }
+    void Options::setSpeciesAttractionRange(size_t id, size_t other, float range) {
+        species_[id].attractionRange[other] = range;
+        recalculateChunks();
+        publishParameters();
+    }
+    void Options::setSpeciesRepulsionRange(size_t id, size_t other, float range) {
+        species_[id].repulsionRange[other] = range;
+        recalculateChunks();
+        publishParameters();
+    }
+    void Options::setParallel(bool parallel) {
+        parallel_ = parallel;
+        publishParameters();
+    }
+    bool Options::isParallel() const {
+        return parallel_;
+    }
+    void Options::setReordering(bool reordering) {
+        reordering_ = reordering;
+        publishParameters();
+    }
+    bool Options::isReordering() const {
+        return reordering_;
+    }
+    void Options::setThreads(size_t count, ThreadPlacement placement) {
+        threadCount_ = count;
+        threadPlacement_ = placement;
+        publishParameters();
+    }
+    size_t Options::getThreadCount() const {
+        return threadCount_;
+    }
+    ThreadPlacement Options::getThreadPlacement() const {
+        return threadPlacement_;
+    }
+    void Options::setClusterAnalysis(float linkingDistance, size_t interval) {
+        clusterLinkingDistance_ = linkingDistance;
+        clusterInterval_ = interval;
+        recalculateChunkRanges();
+        publishParameters();
+    }
+    float Options::getClusterLinkingDistance() const {
+        return clusterLinkingDistance_;
+    }
+    size_t Options::getClusterInterval() const {
+        return clusterInterval_;
+    }
+    void Options::setObservables(size_t interval, const std::string& file) {
+        observablesInterval_ = interval;
+        observablesFile_ = interval == 0 ? "" : file;
+        publishParameters();
+    }
+    size_t Options::getObservablesInterval() const {
+        return observablesInterval_;
+    }
+    const std::string& Options::getObservablesFile() const {
+        return observablesFile_;
+    }
+    void Options::setSharedFrames(size_t interval, const std::string& name) {
+        sharedFramesInterval_ = interval;
+        sharedFramesName_ = interval == 0 ? "" : name;
+        publishParameters();
+    }
+    size_t Options::getSharedFramesInterval() const {
+        return sharedFramesInterval_;
+    }
+    const std::string& Options::getSharedFramesName() const {
+        return sharedFramesName_;
+    }
+    void Options::setQuiescence(float distance, size_t ticks, size_t refreshInterval) {
+        quiescenceDistance_ = distance;
+        quiescenceTicks_ = ticks;
+        quiescenceRefreshInterval_ = refreshInterval;
+        publishParameters();
+    }
+    float Options::getQuiescenceDistance() const {
+        return quiescenceDistance_;
+    }
+    size_t Options::getQuiescenceTicks() const {
+        return quiescenceTicks_;
+    }
+    size_t Options::getQuiescenceRefreshInterval() const {
+        return quiescenceRefreshInterval_;
+    }
+    void Options::setSeed(uint64_t seed) {
+        seed_ = seed;
+        random.seed(seed_);
+        publishParameters();
+    }
+    uint64_t Options::getSeed() const {
+        return seed_;
+    }
+    const std::vector<sf::Vector2u>& Options::getChunkPattern() const
+    {
+        return chunkPattern_;
+    }
+    std::shared_ptr<const SimulationParameters> Options::getParameters() const
+    {
+        return parameters_.load();
+    }
+    void Options::publishParameters()
+    {
+        parametersVersion_++;
+        parameters_.store(std::make_shared<const SimulationParameters>(SimulationParameters{
+            parametersVersion_, timeStep_, worldSize_, frictionMultiplierPerTick_, repulsion_, forceLaw_, tabulatedForces_, chunkCount_, chunkSize_, species_, chunkPattern_, parallel_, seed_, reordering_, threadCount_, threadPlacement_, clusterLinkingDistance_, clusterInterval_, clusterChunkRange_, observablesInterval_, observablesFile_, sharedFramesInterval_, sharedFramesName_, quiescenceDistance_, quiescenceTicks_, quiescenceRefreshInterval_
+        }));
+    }
 }
\ No newline at end of file
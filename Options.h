@@ -1,139 +1,291 @@
-#ifndef OPTIONS_H
-#define OPTIONS_H
-#include <vector>
-#include <random>
-#include "ParticleSpecies.h"
-#include <SFML/Graphics.hpp>
-namespace ParticleLife {
-    /// @brief stores current options
-    class Options {
-    private:
-        /// @brief seconds between frames
-        float frameTime_;
-        /// @brief size of simulation steps in seconds
-        float timeStep_;
-        /// @brief simulation speed multiplier
-        float simSpeed_;
-        /// @brief timeStep / targetSimSpeed - seconds between simulation steps
-        float realTimeStep_;
-        /// @brief width and height
-        float worldSize_;
-        /// @brief portion of velocity left after one second
-        float friction_;
-        /// @brief portion of velocity left after one step
-        float frictionMultiplierPerTick_;
-        /// @brief display radius of particles
-        float particleRadius_;
-        /// @brief maximum repulsion strength (when two particles are on top of each other)
-        float repulsion_;
-        /// @brief number of chunks along each axis
-        size_t chunkCount_;
-        /// @brief width and height of one chunk
-        float chunkSize_;
-        /// @brief maximal of attraction ranges divided by chunk size
-        float maxChunkRange_;
-        /// @brief list of species
-        std::vector<ParticleSpecies> species_;
-        /// @brief chunk offsets sorted by distance from (0, 0) up to max chunk range
-        std::vector<sf::Vector2u> chunkPattern_;
-
-        /// @brief recalculate max chunk range, prepare chunk pattern and recaclculate chunk ranges of particle species
-        void recalculateChunks();
-        /// @brief prepare chunk pattern
-        void recalculateChunkPattern();
-        /// @brief recaclculate chunk ranges of particle species
-        void recalculateChunkRanges();
-        /// @brief generate random Color
-        sf::Color getRandomColor();
-
-        /// @brief calculate square distance from nearest point in (0, 0)
-        class chunkDistanceSquared {
-        public:
-            size_t operator()(sf::Vector2u chunkPos);
-        };
-        /// @brief compare two chunks by distance from nearest point in (0, 0)
-        class chunkDistanceComparer {
-        public:
-            bool operator()(sf::Vector2u a, sf::Vector2u b);
-        };
-    public:
-        /// @brief random engine
-        std::mt19937_64 random;
-        /// @brief is the simulation paused
-        bool paused;
-        /// @brief should the (paused) simulation advance one step
-        bool step;
-
-        /// @brief sets options to their defaults
-        Options();
-        /// @brief set target frames per second
-        void setFPS(float fps);
-        /// @brief get target number of seconds between frames
-        float getFrameTime() const;
-        /// @brief set the size of simulation steps in seconds
-        void setTimeStep(float timeStep);
-        /// @brief get the size of simulation steps in seconds
-        float getTimeStep() const;
-        void setSimulationSpeed(float simulationSpeed);
-        float getSimulationSpeed() const;
-        /// @brief get time step between simulation steps
-        float getRealTimeStep() const;
-        /// @brief set world width and height
-        void setWorldSize(float worldSize);
-        /// @brief get world width and height
-        float getWorldSize() const;
-        /// @brief set portion of velocity left after one second
-        void setFriction(float coefficient);
-        /// @brief get portion of velocity left after one second
-        float getFriction() const;
-        /// @brief get portion of velocity left after one step
-        float getFrictionMultiplierPerTick() const;
-        /// @brief set display radius of the particle
-        void setParticleRadius(float particleRadius);
-        /// @brief get display radius of the particle
-        float getParticleRadius() const;
-        /// @brief set maximum repulsion strength (when two particles are on top of each other)
-        void setRepulsion(float repulsion);
-        /// @brief get maximum repulsion strength (when two particles are on top of each other)
-        float getRepulsion() const;
-        /// @brief set number of chunks along both axes
-        void setChunkCount(size_t count);
-        /// @brief get number of chunks along each axis
-        size_t getChunkCount() const;
-        /// @brief get width and height of each chunk
-        float getChunkSize() const;
-        /// @brief add a new particle species
-        /// @param particleCount number of particles of this new species
-        void addRandomSpecies(size_t particleCount);
-        /// @brief get number of species
-        size_t getSpeciesCount() const;
-        /// @brief get particle species by id
-        const ParticleSpecies& getSpecies(size_t id) const;
-        /// @brief set number of particles of a given species
-        /// @param id species id
-        /// @param count particle count
-        void setParticleCount(size_t id, size_t count);
-        /// @brief set display color of particles of a given species
-        /// @param id species id
-        /// @param color display color
-        void setSpeciesColor(size_t id, sf::Color color);
-        /// @brief set how much are particles of one species attracted to particles of other species
-        /// @param id species id
-        /// @param other other species id
-        /// @param attraction peak attraction strength (negative means repulsion)
-        void setSpeciesAttraction(size_t id, size_t other, float attraction);
-        /// @brief set from how far away are particles of one species attracted to particles of other species
-        /// @param id species id
-        /// @param other other species id
-        /// @param range maximum distance
-        void setSpeciesAttractionRange(size_t id, size_t other, float range);
-        /// @brief set how close must a particle of one species be to a particle of other species to start being repelled
-        /// @param id species id
-        /// @param other other species id
-        /// @param range maximum distance
-        void setSpeciesRepulsionRange(size_t id, size_t other, float range);
-        /// @brief get chunk offsets sorted by distance from (0, 0) up to max chunk range
-        const std::vector<sf::Vector2u>& getChunkPattern() const;
-    };
-}
+#ifndef OPTIONS_H
+#define OPTIONS_H
+#include <vector>
+#include <random>
+#include <string>
+#include "ParticleSpecies.h"
+#include "SimulationParameters.h"
+#include <SFML/Graphics.hpp>
+namespace ParticleLife {
+    /// @brief how particles are displayed
+    enum class DisplayMode {
+        /// @brief each particle is drawn separately
+        Particles,
+        /// @brief number of particles of each species in each pixel is shown as a heat map
+        Density
+    };
+
+    /// @brief stores current options
+    class Options {
+    private:
+        /// @brief seconds between frames
+        float frameTime_;
+        /// @brief size of simulation steps in seconds
+        float timeStep_;
+        /// @brief simulation speed multiplier
+        float simSpeed_;
+        /// @brief timeStep / targetSimSpeed - seconds between simulation steps
+        float realTimeStep_;
+        /// @brief width and height
+        float worldSize_;
+        /// @brief portion of velocity left after one second
+        float friction_;
+        /// @brief portion of velocity left after one step
+        float frictionMultiplierPerTick_;
+        /// @brief display radius of particles
+        float particleRadius_;
+        /// @brief how particles are displayed
+        DisplayMode displayMode_;
+        /// @brief magnification of the view, 1 shows the whole world
+        float viewZoom_;
+        /// @brief center of the view relative to the world size, each coordinate from 0 to 1
+        sf::Vector2f viewCenter_;
+        /// @brief should particles be drawn moved along their velocity by the time passed since the last tick
+        bool smoothMotion_;
+        /// @brief maximum repulsion strength (when two particles are on top of each other)
+        float repulsion_;
+        /// @brief how the force between two particles depends on their distance
+        ForceLaw forceLaw_;
+        /// @brief should forces be interpolated from tables instead of computed exactly
+        bool tabulatedForces_;
+        /// @brief number of chunks along each axis
+        size_t chunkCount_;
+        /// @brief width and height of one chunk
+        float chunkSize_;
+        /// @brief maximal of attraction ranges divided by chunk size
+        float maxChunkRange_;
+        /// @brief list of species
+        std::vector<ParticleSpecies> species_;
+        /// @brief chunk offsets sorted by distance from (0, 0) up to max chunk range
+        std::vector<sf::Vector2u> chunkPattern_;
+        /// @brief should the simulation compute forces on multiple threads
+        bool parallel_;
+        /// @brief seed of the random engine and of particle placement
+        uint64_t seed_;
+        /// @brief should the simulation reorder particles in memory to follow their chunks
+        bool reordering_;
+        /// @brief number of worker threads of the simulation, 0 for one per hardware thread
+        size_t threadCount_;
+        /// @brief how worker threads of the simulation are placed on cores
+        ThreadPlacement threadPlacement_;
+        /// @brief particles closer than this to each other belong to the same cluster
+        float clusterLinkingDistance_;
+        /// @brief ticks between cluster analyses, 0 to disable them
+        size_t clusterInterval_;
+        /// @brief amount of closest chunks to check for particles within cluster linking distance
+        size_t clusterChunkRange_;
+        /// @brief ticks between measurements of observables, 0 to disable them
+        size_t observablesInterval_;
+        /// @brief file to write observables into
+        std::string observablesFile_;
+        /// @brief ticks between frames published into shared memory, 0 to disable them
+        size_t sharedFramesInterval_;
+        /// @brief name of the shared memory region to publish frames into
+        std::string sharedFramesName_;
+        /// @brief particles staying within this distance of where they settled are at rest, 0 to compute all forces every tick
+        float quiescenceDistance_;
+        /// @brief ticks all particles within reach of a chunk must be at rest before its forces are reused
+        size_t quiescenceTicks_;
+        /// @brief ticks between passes recomputing all forces, which measure the error of the reused ones
+        size_t quiescenceRefreshInterval_;
+        /// @brief version of the last published parameters
+        size_t parametersVersion_;
+        /// @brief last published parameters
+        ParametersHandle parameters_;
+
+        /// @brief recalculate max chunk range, prepare chunk pattern and recaclculate chunk ranges of particle species
+        void recalculateChunks();
+        /// @brief prepare chunk pattern
+        void recalculateChunkPattern();
+        /// @brief recaclculate chunk ranges of particle species and of cluster analysis
+        void recalculateChunkRanges();
+        /// @brief get amount of closest chunks to check for particles within given distance
+        /// @param distancesSquared squared distances of the chunk pattern entries in chunks
+        /// @param range distance
+        size_t getChunkRange(const std::vector<size_t>& distancesSquared, float range) const;
+        /// @brief publish a new immutable copy of the options the simulation depends on
+        void publishParameters();
+        /// @brief generate random Color
+        sf::Color getRandomColor();
+
+        /// @brief calculate square distance from nearest point in (0, 0)
+        class chunkDistanceSquared {
+        public:
+            size_t operator()(sf::Vector2u chunkPos);
+        };
+        /// @brief compare two chunks by distance from nearest point in (0, 0)
+        class chunkDistanceComparer {
+        public:
+            bool operator()(sf::Vector2u a, sf::Vector2u b);
+        };
+    public:
+        /// @brief random engine
+        std::mt19937_64 random;
+        /// @brief is the simulation paused
+        bool paused;
+        /// @brief should the (paused) simulation advance one step
+        bool step;
+
+        /// @brief sets options to their defaults, seeded by the current time
+        Options();
+        /// @brief sets options to their defaults
+        /// @param seed seed of the random engine and of particle placement
+        Options(uint64_t seed);
+        /// @brief set target frames per second
+        void setFPS(float fps);
+        /// @brief get target number of seconds between frames
+        float getFrameTime() const;
+        /// @brief set the size of simulation steps in seconds
+        void setTimeStep(float timeStep);
+        /// @brief get the size of simulation steps in seconds
+        float getTimeStep() const;
+        void setSimulationSpeed(float simulationSpeed);
+        float getSimulationSpeed() const;
+        /// @brief get time step between simulation steps
+        float getRealTimeStep() const;
+        /// @brief set world width and height
+        void setWorldSize(float worldSize);
+        /// @brief get world width and height
+        float getWorldSize() const;
+        /// @brief set portion of velocity left after one second
+        void setFriction(float coefficient);
+        /// @brief get portion of velocity left after one second
+        float getFriction() const;
+        /// @brief get portion of velocity left after one step
+        float getFrictionMultiplierPerTick() const;
+        /// @brief set display radius of the particle
+        void setParticleRadius(float particleRadius);
+        /// @brief get display radius of the particle
+        float getParticleRadius() const;
+        /// @brief set how particles are displayed
+        void setDisplayMode(DisplayMode displayMode);
+        /// @brief get how particles are displayed
+        DisplayMode getDisplayMode() const;
+        /// @brief largest magnification of the view
+        static constexpr float MAX_VIEW_ZOOM = 1000;
+        /// @brief set which part of the world is displayed
+        /// @param zoom magnification from 1 (whole world) to MAX_VIEW_ZOOM
+        /// @param center center of the view in world coordinates, wrapped around the world
+        void setView(float zoom, sf::Vector2f center);
+        /// @brief get magnification of the view
+        float getViewZoom() const;
+        /// @brief get center of the view in world coordinates
+        sf::Vector2f getViewCenter() const;
+        /// @brief set whether particles should be drawn moved along their velocity by the time passed since the last tick
+        void setSmoothMotion(bool smooth);
+        /// @brief get whether particles are drawn moved along their velocity by the time passed since the last tick
+        bool isSmoothMotion() const;
+        /// @brief set maximum repulsion strength (when two particles are on top of each other)
+        void setRepulsion(float repulsion);
+        /// @brief get maximum repulsion strength (when two particles are on top of each other)
+        float getRepulsion() const;
+        /// @brief set how the force between two particles depends on their distance
+        void setForceLaw(ForceLaw forceLaw);
+        /// @brief get how the force between two particles depends on their distance
+        ForceLaw getForceLaw() const;
+        /// @brief set whether forces should be interpolated from tables instead of computed exactly
+        void setTabulatedForces(bool tabulated);
+        /// @brief get whether forces are interpolated from tables instead of computed exactly
+        bool isTabulatedForces() const;
+        /// @brief set number of chunks along both axes
+        void setChunkCount(size_t count);
+        /// @brief get number of chunks along each axis
+        size_t getChunkCount() const;
+        /// @brief get width and height of each chunk
+        float getChunkSize() const;
+        /// @brief add a new particle species
+        /// @param particleCount number of particles of this new species
+        void addRandomSpecies(size_t particleCount);
+        /// @brief largest attraction range drawn for randomly generated interactions
+        static constexpr float MAX_RANDOM_ATTRACTION_RANGE = 8;
+        /// @brief randomly generate new attraction strengths and ranges between all species
+        void randomizeInteractions();
+        /// @brief get number of species
+        size_t getSpeciesCount() const;
+        /// @brief get particle species by id
+        const ParticleSpecies& getSpecies(size_t id) const;
+        /// @brief set number of particles of a given species
+        /// @param id species id
+        /// @param count particle count
+        void setParticleCount(size_t id, size_t count);
+        /// @brief set display color of particles of a given species
+        /// @param id species id
+        /// @param color display color
+        void setSpeciesColor(size_t id, sf::Color color);
+        /// @brief set how much are particles of one species attracted to particles of other species
+        /// @param id species id
+        /// @param other other species id
+        /// @param attraction peak attraction strength (negative means repulsion)
+        void setSpeciesAttraction(size_t id, size_t other, float attraction);
+        /// @brief set from how far away are particles of one species attracted to particles of other species
+        /// @param id species id
+        /// @param other other species id
+        /// @param range maximum distance
+        void setSpeciesAttractionRange(size_t id, size_t other, float range);
+        /// @brief set how close must a particle of one species be to a particle of other species to start being repelled
+        /// @param id species id
+        /// @param other other species id
+        /// @param range maximum distance
+        void setSpeciesRepulsionRange(size_t id, size_t other, float range);
+        /// @brief set whether the simulation should compute forces on multiple threads
+        void setParallel(bool parallel);
+        /// @brief get whether the simulation should compute forces on multiple threads
+        bool isParallel() const;
+        /// @brief set whether the simulation should reorder particles in memory to follow their chunks
+        void setReordering(bool reordering);
+        /// @brief get whether the simulation should reorder particles in memory to follow their chunks
+        bool isReordering() const;
+        /// @brief set worker threads of the simulation
+        /// @param count number of threads, 0 for one per hardware thread
+        /// @param placement how to place the threads on cores
+        void setThreads(size_t count, ThreadPlacement placement);
+        /// @brief get number of worker threads of the simulation, 0 for one per hardware thread
+        size_t getThreadCount() const;
+        /// @brief get how worker threads of the simulation are placed on cores
+        ThreadPlacement getThreadPlacement() const;
+        /// @brief set cluster analysis
+        /// @param linkingDistance particles closer than this to each other belong to the same cluster
+        /// @param interval ticks between analyses, 0 to disable them
+        void setClusterAnalysis(float linkingDistance, size_t interval);
+        /// @brief get distance under which particles belong to the same cluster
+        float getClusterLinkingDistance() const;
+        /// @brief get ticks between cluster analyses, 0 if they are disabled
+        size_t getClusterInterval() const;
+        /// @brief set measurement of observables
+        /// @param interval ticks between measurements, 0 to disable them
+        /// @param file file to write them into
+        void setObservables(size_t interval, const std::string& file);
+        /// @brief get ticks between measurements of observables, 0 if they are disabled
+        size_t getObservablesInterval() const;
+        /// @brief get file to write observables into
+        const std::string& getObservablesFile() const;
+        /// @brief set publishing of frames into shared memory
+        /// @param interval ticks between frames, 0 to disable them
+        /// @param name name of the shared memory region
+        void setSharedFrames(size_t interval, const std::string& name);
+        /// @brief get ticks between frames published into shared memory, 0 if they are disabled
+        size_t getSharedFramesInterval() const;
+        /// @brief get name of the shared memory region to publish frames into
+        const std::string& getSharedFramesName() const;
+        /// @brief set reusing forces of chunks where particles settled
+        /// @param distance particles staying within this distance of where they settled are at rest, 0 to compute all forces every tick
+        /// @param ticks ticks all particles within reach of a chunk must be at rest before its forces are reused
+        /// @param refreshInterval ticks between passes recomputing all forces
+        void setQuiescence(float distance, size_t ticks, size_t refreshInterval);
+        /// @brief get distance within which settled particles are at rest, 0 if all forces are computed every tick
+        float getQuiescenceDistance() const;
+        /// @brief get ticks all particles within reach of a chunk must be at rest before its forces are reused
+        size_t getQuiescenceTicks() const;
+        /// @brief get ticks between passes recomputing all forces
+        size_t getQuiescenceRefreshInterval() const;
+        /// @brief set seed of particle placement and reseed the random engine with it
+        void setSeed(uint64_t seed);
+        /// @brief get seed of the random engine and of particle placement
+        uint64_t getSeed() const;
+        /// @brief get chunk offsets sorted by distance from (0, 0) up to max chunk range
+        const std::vector<sf::Vector2u>& getChunkPattern() const;
+        /// @brief get the latest published copy of the options the simulation depends on, safe to call from any thread
+        std::shared_ptr<const SimulationParameters> getParameters() const;
+    };
+}
 #endif
\ No newline at end of file
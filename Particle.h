@@ -1,21 +1,29 @@
-#ifndef PARTICLE_H
-#define PARTICLE_H
-#include <SFML/Graphics.hpp>
-namespace ParticleLife {
-    class Particle {
-    private:
-        sf::Vector2f position_;
-        sf::Vector2f velocity_;
-        sf::Vector2f acceleration_;
-    public:
-        Particle();
-        Particle(sf::Vector2f position);
-        /// @brief update particle values by simulation one time step
-        void tick(float timeStep, float worldSize, float dragMultiplier);
-        /// @brief modify this particle's acceleration 
-        void addForce(sf::Vector2f acceleration);
-        /// @brief get this particle's position
-        sf::Vector2f getPosition() const;
-    };
-}
+#ifndef PARTICLE_H
+#define PARTICLE_H
+#include "UninitializedAllocator.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+namespace ParticleLife {
+    class Particle {
+    private:
+        sf::Vector2f position_;
+        sf::Vector2f velocity_;
+        sf::Vector2f acceleration_;
+    public:
+        Particle();
+        Particle(sf::Vector2f position);
+        /// @brief update particle values by simulation one time step
+        void tick(float timeStep, float worldSize, float dragMultiplier);
+        /// @brief set this particle's acceleration, it is kept until set again
+        void setAcceleration(sf::Vector2f acceleration);
+        /// @brief get this particle's acceleration
+        sf::Vector2f getAcceleration() const;
+        /// @brief get this particle's position
+        sf::Vector2f getPosition() const;
+        /// @brief get this particle's velocity
+        sf::Vector2f getVelocity() const;
+    };
+    /// @brief particles of one species, resizing leaves new particles unconstructed so the thread which fills them in places them in memory
+    using ParticleVector = std::vector<Particle, UninitializedAllocator<Particle>>;
+}
 #endif
\ No newline at end of file
@@ -1,86 +1,112 @@
-#include <iostream>
-#include "ProgramManager.h"
-#include <algorithm>
-namespace ParticleLife {
-    constexpr size_t FRAME_DROP_THRESHOLD = 4;
-    constexpr size_t TICK_DROP_THRESHOLD = 10;
-    constexpr double RATE_DISPLAY_SMOOTHING = 0.25;
-
-    constexpr double NANOSECONDS_PER_SECOND = 1000000000.0;
-    constexpr char ONE_DECIMAL[] = "{:.1f}";
-
-    ProgramManager::ProgramManager() :
-        options_(), simulation_(options_), renderer_(options_), inputHandler_(options_), startTime_(),
-        lastFrame_(0), lastTick_(0), realLastFrame_(0), realLastTick_(0), fps_(1 / options_.getFrameTime()), tps_(1 / options_.getRealTimeStep()) {}
-
-    void ProgramManager::run() {
-        init();
-        mainLoop();
-    }
-
-    void ProgramManager::init() {
-        startTime_ = std::chrono::steady_clock::now();
-        simulation_.init();
-        renderer_.init();
-        inputHandler_.init();
-    }
-
-    void ProgramManager::mainLoop() {
-        while (true) {
-            double time = getTimeSinceStart();
-            if ((!options_.paused && time - lastTick_ >= options_.getRealTimeStep()) || options_.step) {
-                options_.step = false;
-                tick(time);
-            }
-            if (time - lastFrame_ >= options_.getFrameTime())
-            {
-                renderFrame(time);
-            }
-            pollInputs();
-        }
-    }
-
-    double ProgramManager::getTimeSinceStart() const {
-        return (std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now() - startTime_).count()) / NANOSECONDS_PER_SECOND;
-    }
-
-    void ProgramManager::tick(double time) {
-        if (time - lastTick_ >= options_.getRealTimeStep() * TICK_DROP_THRESHOLD)
-            lastTick_ = time - options_.getRealTimeStep() * (TICK_DROP_THRESHOLD - 1);
-        else
-            lastTick_ += options_.getRealTimeStep();
-
-        double ellapsed = time - realLastTick_;
-        double clamped = std::min(ellapsed, RATE_DISPLAY_SMOOTHING);
-        tps_ = (tps_ * (RATE_DISPLAY_SMOOTHING - clamped) + clamped / ellapsed) / RATE_DISPLAY_SMOOTHING;
-        realLastTick_ = time;
-
-        simulation_.tick();
-    }
-    void ProgramManager::renderFrame(double time) {
-        if (time - lastFrame_ >= options_.getFrameTime() * FRAME_DROP_THRESHOLD)
-            lastFrame_ = time - options_.getFrameTime() * (FRAME_DROP_THRESHOLD - 1);
-        else
-            lastFrame_ += options_.getFrameTime();
-
-        double ellapsed = time - realLastFrame_;
-        double clamped = std::min(ellapsed, RATE_DISPLAY_SMOOTHING);
-        fps_ = (fps_ * (RATE_DISPLAY_SMOOTHING - clamped) + clamped / ellapsed) / RATE_DISPLAY_SMOOTHING;
-        realLastFrame_ = time;
-
-        renderer_.handleEvents();
-
-        renderer_.clear();
-        renderer_.renderParticles(simulation_.getParticles());
-        renderer_.renderText(0, "Ellapsed: " + std::format(ONE_DECIMAL, simulation_.getTime()) + "s", false);
-        if (options_.paused)
-            renderer_.renderText(0, "PAUSED", true);
-        else
-            renderer_.renderText(0, std::format(ONE_DECIMAL, tps_) + "/" + std::format(ONE_DECIMAL, 1 / options_.getRealTimeStep()) + " tps", true);
-        renderer_.renderText(1, std::format(ONE_DECIMAL, fps_) + " fps", true);
-        renderer_.display();
-    }
-    void ProgramManager::pollInputs() {
-        inputHandler_.pollInputs();
-    }
+#include <iostream>
+#include "ProgramManager.h"
+#include <algorithm>
+namespace ParticleLife {
+    constexpr size_t FRAME_DROP_THRESHOLD = 4;
+    constexpr size_t TICK_DROP_THRESHOLD = 10;
+    constexpr double RATE_DISPLAY_SMOOTHING = 0.25;
+
+    constexpr double NANOSECONDS_PER_SECOND = 1000000000.0;
+    constexpr double MILLISECONDS_PER_SECOND = 1000.0;
+    constexpr char ONE_DECIMAL[] = "{:.1f}";
+
+    ProgramManager::ProgramManager() :
+        options_(), simulation_(options_), renderer_(options_), controlServer_(), metrics_(), inputHandler_(options_, simulation_, controlServer_, metrics_), startTime_(),
+        lastFrame_(0), lastTick_(0), realLastFrame_(0), realLastTick_(0), fps_(1 / options_.getFrameTime()), tps_(1 / options_.getRealTimeStep()), onSchedule_(false) {}
+
+    void ProgramManager::run() {
+        init();
+        mainLoop();
+    }
+
+    void ProgramManager::init() {
+        startTime_ = std::chrono::steady_clock::now();
+        simulation_.init();
+        renderer_.init();
+        inputHandler_.init();
+    }
+
+    void ProgramManager::mainLoop() {
+        while (true) {
+            double time = getTimeSinceStart();
+            // time spent paused isn't a stall
+            if (options_.paused)
+                onSchedule_ = false;
+            if ((!options_.paused && time - lastTick_ >= options_.getRealTimeStep()) || options_.step) {
+                options_.step = false;
+                tick(time);
+            }
+            if (time - lastFrame_ >= options_.getFrameTime())
+            {
+                renderFrame(time);
+            }
+            pollInputs();
+        }
+    }
+
+    double ProgramManager::getTimeSinceStart() const {
+        return (std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now() - startTime_).count()) / NANOSECONDS_PER_SECOND;
+    }
+
+    void ProgramManager::tick(double time) {
+        if (time - lastTick_ >= options_.getRealTimeStep() * TICK_DROP_THRESHOLD) {
+            // all ticks due beyond the threshold are skipped
+            if (onSchedule_)
+                metrics_.droppedTicks += (uint64_t)((time - lastTick_) / options_.getRealTimeStep()) - (TICK_DROP_THRESHOLD - 1);
+            lastTick_ = time - options_.getRealTimeStep() * (TICK_DROP_THRESHOLD - 1);
+        }
+        else
+            lastTick_ += options_.getRealTimeStep();
+        if (onSchedule_)
+            metrics_.tickIntervals.record((time - realLastTick_) * MILLISECONDS_PER_SECOND);
+        onSchedule_ = !options_.paused;
+
+        double ellapsed = time - realLastTick_;
+        double clamped = std::min(ellapsed, RATE_DISPLAY_SMOOTHING);
+        tps_ = (tps_ * (RATE_DISPLAY_SMOOTHING - clamped) + clamped / ellapsed) / RATE_DISPLAY_SMOOTHING;
+        realLastTick_ = time;
+
+        simulation_.tick();
+        metrics_.tickDurations.record(simulation_.getPhaseTimes().total);
+        controlServer_.publishTelemetry({ simulation_.getTickCount(), simulation_.getTime(), tps_, fps_, options_.paused, simulation_.getPhaseTimes() });
+    }
+    void ProgramManager::renderFrame(double time) {
+        if (time - lastFrame_ >= options_.getFrameTime() * FRAME_DROP_THRESHOLD) {
+            // the first frame has no schedule to fall behind
+            if (realLastFrame_ > 0)
+                metrics_.droppedFrames += (uint64_t)((time - lastFrame_) / options_.getFrameTime()) - (FRAME_DROP_THRESHOLD - 1);
+            lastFrame_ = time - options_.getFrameTime() * (FRAME_DROP_THRESHOLD - 1);
+        }
+        else
+            lastFrame_ += options_.getFrameTime();
+        if (realLastFrame_ > 0)
+            metrics_.frameIntervals.record((time - realLastFrame_) * MILLISECONDS_PER_SECOND);
+
+        double ellapsed = time - realLastFrame_;
+        double clamped = std::min(ellapsed, RATE_DISPLAY_SMOOTHING);
+        fps_ = (fps_ * (RATE_DISPLAY_SMOOTHING - clamped) + clamped / ellapsed) / RATE_DISPLAY_SMOOTHING;
+        realLastFrame_ = time;
+
+        // time may have been taken before the tick that preceded this frame
+        double start = getTimeSinceStart();
+        renderer_.handleEvents();
+
+        renderer_.clear();
+        // particles are drawn the fraction of the tick interval passed since the last tick along their way to the next one
+        float extrapolation = 0;
+        if (options_.isSmoothMotion() && !options_.paused)
+            extrapolation = (float)std::clamp((time - lastTick_) / options_.getRealTimeStep(), 0.0, 1.0) * options_.getTimeStep();
+        renderer_.renderParticles(simulation_.getParticles(), simulation_.getChunkMap(), extrapolation);
+        renderer_.renderText(0, "Ellapsed: " + std::format(ONE_DECIMAL, simulation_.getTime()) + "s", false);
+        if (options_.paused)
+            renderer_.renderText(0, "PAUSED", true);
+        else
+            renderer_.renderText(0, std::format(ONE_DECIMAL, tps_) + "/" + std::format(ONE_DECIMAL, 1 / options_.getRealTimeStep()) + " tps", true);
+        renderer_.renderText(1, std::format(ONE_DECIMAL, fps_) + " fps", true);
+        renderer_.display();
+        metrics_.frameDurations.record((getTimeSinceStart() - start) * MILLISECONDS_PER_SECOND);
+    }
+    void ProgramManager::pollInputs() {
+        inputHandler_.pollInputs();
+    }
 }
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "Rasterizer.h"
+#include <algorithm>
+#include <cmath>
+namespace ParticleLife {
+    constexpr size_t BYTES_PER_PIXEL = 4;
+
+    FrameSnapshot FrameSnapshot::capture(const std::vector<ParticleVector>& particles, const Options& options)
+    {
+        FrameSnapshot frame = { {}, {}, options.getWorldSize(), options.getParticleRadius() };
+        frame.positions.resize(particles.size());
+        for (size_t s = 0; s < particles.size(); s++)
+        {
+            frame.colors.push_back(options.getSpecies(s).color);
+            frame.positions[s].reserve(particles[s].size());
+            for (auto&& p : particles[s]) {
+                frame.positions[s].push_back(p.getPosition());
+            }
+        }
+        return frame;
+    }
+
+    Rasterizer::Rasterizer(unsigned int size) : size_(size), pixels_((size_t)size * size * BYTES_PER_PIXEL) {}
+
+    void Rasterizer::draw(const FrameSnapshot& frame)
+    {
+        for (size_t i = 0; i < pixels_.size(); i += BYTES_PER_PIXEL)
+        {
+            pixels_[i] = sf::Color::Black.r;
+            pixels_[i + 1] = sf::Color::Black.g;
+            pixels_[i + 2] = sf::Color::Black.b;
+            pixels_[i + 3] = sf::Color::Black.a;
+        }
+        float pixelsPerUnit = size_ / frame.worldSize;
+        float radius = frame.particleRadius * pixelsPerUnit;
+        for (size_t s = 0; s < frame.positions.size(); s++)
+        {
+            for (auto&& position : frame.positions[s]) {
+                if (frame.particleRadius == 0)
+                    drawPoint(position * pixelsPerUnit, frame.colors[s]);
+                else
+                    drawCircle(position * pixelsPerUnit, radius, frame.colors[s]);
+            }
+        }
+    }
+
+    void Rasterizer::drawPoint(sf::Vector2f point, sf::Color color)
+    {
+        if (point.x < 0 || point.y < 0 || point.x >= size_ || point.y >= size_)
+            return;
+        sf::Uint8* pixel = &pixels_[((size_t)point.y * size_ + (size_t)point.x) * BYTES_PER_PIXEL];
+        pixel[0] = color.r;
+        pixel[1] = color.g;
+        pixel[2] = color.b;
+        pixel[3] = color.a;
+    }
+
+    void Rasterizer::drawCircle(sf::Vector2f center, float radius, sf::Color color)
+    {
+        // pixel centers are at half coordinates, same as in the window
+        int top = std::max(0, (int)std::floorf(center.y - radius));
+        int bottom = std::min((int)size_ - 1, (int)std::floorf(center.y + radius));
+        int left = std::max(0, (int)std::floorf(center.x - radius));
+        int right = std::min((int)size_ - 1, (int)std::floorf(center.x + radius));
+        float radiusSquared = radius * radius;
+        for (int y = top; y <= bottom; y++)
+        {
+            float dy = y + 0.5f - center.y;
+            for (int x = left; x <= right; x++)
+            {
+                float dx = x + 0.5f - center.x;
+                if (dx * dx + dy * dy <= radiusSquared)
+                    drawPoint(sf::Vector2f((float)x, (float)y), color);
+            }
+        }
+    }
+}
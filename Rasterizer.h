@@ -0,0 +1,45 @@
+#ifndef RASTERIZER_H
+#define RASTERIZER_H
+#include "Options.h"
+#include "Particle.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+namespace ParticleLife {
+    /// @brief copy of everything needed to draw one frame, independent of the simulation which keeps running
+    struct FrameSnapshot {
+        /// @brief particle positions split by species
+        std::vector<std::vector<sf::Vector2f>> positions;
+        /// @brief display color of each species
+        std::vector<sf::Color> colors;
+        float worldSize;
+        /// @brief display radius of particles, 0 to draw them as single pixels
+        float particleRadius;
+        /// @brief copy particle positions and display settings
+        /// @param particles particles split by species
+        /// @param options options to read display settings from
+        static FrameSnapshot capture(const std::vector<ParticleVector>& particles, const Options& options);
+    };
+
+    /// @brief draws particles on the CPU into a square RGBA buffer, the same way Renderer draws them into the window
+    class Rasterizer {
+    private:
+        /// @brief width and height in pixels
+        unsigned int size_;
+        /// @brief 4 bytes per pixel, row by row
+        std::vector<sf::Uint8> pixels_;
+        /// @brief set color of the pixel containing given point, does nothing outside of the image
+        void drawPoint(sf::Vector2f point, sf::Color color);
+        /// @brief fill pixels with centers within given distance from the center
+        void drawCircle(sf::Vector2f center, float radius, sf::Color color);
+    public:
+        /// @param size width and height in pixels
+        Rasterizer(unsigned int size);
+        /// @brief clear the image and draw the frame onto it
+        void draw(const FrameSnapshot& frame);
+        /// @brief get width and height in pixels
+        inline unsigned int getSize() const { return size_; }
+        /// @brief get the image, 4 bytes per pixel, row by row
+        inline const std::vector<sf::Uint8>& getPixels() const { return pixels_; }
+    };
+}
+#endif
@@ -1,93 +1,296 @@
-#include "Renderer.h"
-#include <iostream>
-namespace ParticleLife {
-    constexpr char WINDOW_TITLE[] = "Zapoctovy projekt - Vilem Gutvald";
-
-    constexpr unsigned int WINDOW_WIDTH = 1280;
-    constexpr unsigned int WINDOW_HEIGHT = 720;
-
-    constexpr char FONT_FILENAME[] = "font.ttf";
-    constexpr float TEXT_LINE_HEIGHT = 30;
-    constexpr float TEXT_PADDING = 6;
-
-    constexpr size_t CIRCLE_POINTS = 8;
-
-    Renderer::Renderer(Options& options) :
-        options_(options), window_(sf::RenderWindow(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), WINDOW_TITLE)), font_(), text_() {}
-
-    void Renderer::init() {
-        font_.loadFromFile(FONT_FILENAME);
-        text_.setFont(font_);
-    }
-    void Renderer::handleEvents() {
-        sf::Event event;
-        while (window_.pollEvent(event)) {
-            if (event.type == sf::Event::Closed || sf::Keyboard::isKeyPressed(sf::Keyboard::Escape)) {
-                window_.close();
-                exit(0);
-            }
-            if (event.type == sf::Event::Resized)
-            {
-                sf::FloatRect view(0, 0, (float)event.size.width, (float)event.size.height);
-                window_.setView(sf::View(view));
-            }
-        }
-    }
-    void Renderer::clear() {
-        window_.clear();
-    }
-    void Renderer::renderParticles(const std::vector<std::vector<Particle>>& particles) {
-        float minSize = std::min(window_.getSize().x, window_.getSize().y);
-        float pixelsPerUnit = minSize / options_.getWorldSize();
-        sf::Vector2f windowCenterOffset = sf::Vector2f((window_.getSize().x - minSize) / 2, (window_.getSize().y - minSize) / 2);
-        if (options_.getParticleRadius() == 0)
-            renderParticlesAsPoints(particles, pixelsPerUnit, windowCenterOffset);
-        else
-            renderParticlesAsCircles(particles, pixelsPerUnit, windowCenterOffset);
-    }
-
-    void Renderer::renderParticlesAsPoints(const std::vector<std::vector<Particle>>& particles, float pixelsPerUnit, sf::Vector2f windowCenterOffset)
-    {
-        sf::VertexArray verts = sf::VertexArray();
-        for (size_t s = 0; s < particles.size(); s++)
-        {
-            for (auto&& p : particles[s]) {
-                verts.append(sf::Vertex(p.getPosition() * pixelsPerUnit + windowCenterOffset, options_.getSpecies(s).color));
-            }
-        }
-        window_.draw(&verts[0], verts.getVertexCount(), sf::Points);
-    }
-
-    void Renderer::renderParticlesAsCircles(const std::vector<std::vector<Particle>>& particles, float pixelsPerUnit, sf::Vector2f windowCenterOffset)
-    {
-        float circleRadiusPx = options_.getParticleRadius() * pixelsPerUnit;
-        sf::Vector2f circleCenterOffset(-circleRadiusPx, -circleRadiusPx);
-        sf::CircleShape circle(circleRadiusPx, CIRCLE_POINTS);
-
-        for (size_t s = 0; s < particles.size(); s++)
-        {
-            circle.setFillColor(options_.getSpecies(s).color);
-            for (auto&& p : particles[s]) {
-                circle.setPosition(p.getPosition() * pixelsPerUnit + windowCenterOffset + circleCenterOffset);
-                window_.draw(circle);
-            }
-        }
-    }
-
-    void Renderer::renderText(size_t line, std::string text, bool alignRight) {
-        text_.setString(text);
-        float yPos = TEXT_LINE_HEIGHT * line + TEXT_PADDING;
-        if (alignRight) {
-            unsigned int windowWidth = window_.getSize().x;
-            auto textWidth = text_.getLocalBounds().width;
-            text_.setPosition(windowWidth - textWidth - TEXT_PADDING, yPos);
-        }
-        else {
-            text_.setPosition(TEXT_PADDING, yPos);
-        }
-        window_.draw(text_);
-    }
-    void Renderer::display() {
-        window_.display();
-    }
+#include "Renderer.h"
+#include <iostream>
+#include <execution>
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <cmath>
+namespace ParticleLife {
+    constexpr char WINDOW_TITLE[] = "Zapoctovy projekt - Vilem Gutvald";
+
+    constexpr unsigned int WINDOW_WIDTH = 1280;
+    constexpr unsigned int WINDOW_HEIGHT = 720;
+
+    constexpr char FONT_FILENAME[] = "font.ttf";
+    constexpr float TEXT_LINE_HEIGHT = 30;
+    constexpr float TEXT_PADDING = 6;
+
+    constexpr size_t CIRCLE_POINTS = 8;
+    /// @brief density (relative to the average) at which pixels of the density map reach full brightness
+    constexpr float DENSITY_SATURATION = 16;
+    constexpr size_t BYTES_PER_PIXEL = 4;
+    /// @brief magnification change per mouse wheel tick
+    constexpr float ZOOM_STEP = 1.25f;
+
+    Renderer::Renderer(Options& options) :
+        options_(options), window_(sf::RenderWindow(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), WINDOW_TITLE)), font_(), text_(), dragging_(false), dragPosition_(), visibleChunks_(), visiblePositions_(), densityCounts_(), densityPixels_(), densityTexture_() {}
+
+    void Renderer::init() {
+        font_.loadFromFile(FONT_FILENAME);
+        text_.setFont(font_);
+    }
+    void Renderer::handleEvents() {
+        sf::Event event;
+        while (window_.pollEvent(event)) {
+            if (event.type == sf::Event::Closed || sf::Keyboard::isKeyPressed(sf::Keyboard::Escape)) {
+                window_.close();
+                exit(0);
+            }
+            if (event.type == sf::Event::Resized)
+            {
+                sf::FloatRect view(0, 0, (float)event.size.width, (float)event.size.height);
+                window_.setView(sf::View(view));
+            }
+            if (event.type == sf::Event::MouseWheelScrolled)
+                zoom(event.mouseWheelScroll.delta, sf::Vector2i(event.mouseWheelScroll.x, event.mouseWheelScroll.y));
+            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                dragging_ = true;
+                dragPosition_ = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+            }
+            if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left)
+                dragging_ = false;
+            if (event.type == sf::Event::MouseMoved && dragging_) {
+                sf::Vector2i position(event.mouseMove.x, event.mouseMove.y);
+                sf::Vector2f moved = sf::Vector2f(position - dragPosition_) / getViewport().pixelsPerUnit;
+                options_.setView(options_.getViewZoom(), options_.getViewCenter() - moved);
+                dragPosition_ = position;
+            }
+        }
+    }
+    void Renderer::clear() {
+        window_.clear();
+    }
+    void Renderer::renderParticles(const std::vector<ParticleVector>& particles, const ChunkMap& chunks, float extrapolation) {
+        if (window_.getSize().x == 0 || window_.getSize().y == 0)
+            return;
+        Viewport viewport = getViewport();
+        bool circles = options_.getDisplayMode() == DisplayMode::Particles && options_.getParticleRadius() > 0;
+        collectVisibleParticles(particles, chunks, viewport, circles ? options_.getParticleRadius() : 0, extrapolation);
+        if (options_.getDisplayMode() == DisplayMode::Density) {
+            size_t particleCount = 0;
+            for (auto&& s : particles)
+                particleCount += s.size();
+            renderParticlesAsDensity(viewport, particleCount);
+        }
+        else if (circles)
+            renderParticlesAsCircles(viewport);
+        else
+            renderParticlesAsPoints(viewport);
+    }
+
+    Renderer::Viewport Renderer::getViewport() const
+    {
+        float worldSize = options_.getWorldSize();
+        float windowWidth = (float)window_.getSize().x;
+        float windowHeight = (float)window_.getSize().y;
+        Viewport viewport;
+        // at zoom 1 the whole world fits into the shorter side of the window
+        viewport.pixelsPerUnit = std::min(windowWidth, windowHeight) * options_.getViewZoom() / worldSize;
+        viewport.span = sf::Vector2f(std::min(windowWidth / viewport.pixelsPerUnit, worldSize), std::min(windowHeight / viewport.pixelsPerUnit, worldSize));
+        viewport.offset = sf::Vector2f((windowWidth - viewport.span.x * viewport.pixelsPerUnit) / 2, (windowHeight - viewport.span.y * viewport.pixelsPerUnit) / 2);
+        viewport.origin = options_.getViewCenter() - viewport.span / 2.0f;
+        return viewport;
+    }
+
+    void Renderer::zoom(float delta, sf::Vector2i mousePosition)
+    {
+        Viewport before = getViewport();
+        sf::Vector2f mouse = before.origin + (sf::Vector2f(mousePosition) - before.offset) / before.pixelsPerUnit;
+        options_.setView(options_.getViewZoom() * std::pow(ZOOM_STEP, delta), options_.getViewCenter());
+        Viewport after = getViewport();
+        sf::Vector2f shift = mouse - (after.origin + (sf::Vector2f(mousePosition) - after.offset) / after.pixelsPerUnit);
+        options_.setView(options_.getViewZoom(), options_.getViewCenter() + shift);
+    }
+
+    void Renderer::collectVisibleParticles(const std::vector<ParticleVector>& particles, const ChunkMap& chunks, const Viewport& viewport, float margin, float extrapolation)
+    {
+        float worldSize = options_.getWorldSize();
+        size_t speciesCount = particles.size();
+        size_t particleCount = 0;
+        for (auto&& s : particles)
+            particleCount += s.size();
+        // no margin along an axis the view covers completely, particles near one edge of the world would be moved to the other one
+        sf::Vector2f margins(viewport.span.x < worldSize ? margin : 0, viewport.span.y < worldSize ? margin : 0);
+        sf::Vector2f start = viewport.origin - margins;
+        sf::Vector2f limit = viewport.span + margins * 2.0f;
+
+        // the chunk map only helps while it contains all current particles, which it doesn't before the first tick
+        visibleChunks_.clear();
+        bool culling = chunks.getChunkCount() > 0 && chunks.getParticles().size() == particleCount;
+        if (culling) {
+            size_t chunkCount = chunks.getChunkCount();
+            float chunkSize = chunks.getChunkSize();
+            // flags of chunk columns or rows intersecting a range, extended by a chunk on each side for particles which left their chunk during the last tick or the extrapolation
+            auto findVisibleLines = [chunkCount, chunkSize](float begin, float length, std::vector<char>& visible) {
+                long long first = (long long)std::floor(begin / chunkSize) - 1;
+                long long count = (long long)std::ceil(length / chunkSize) + 3;
+                visible.assign(chunkCount, count >= (long long)chunkCount);
+                for (long long i = 0; i < count && i < (long long)chunkCount; i++)
+                {
+                    long long line = (first + i) % (long long)chunkCount;
+                    visible[line < 0 ? line + chunkCount : line] = 1;
+                }
+                return (size_t)std::count(visible.begin(), visible.end(), 1);
+            };
+            std::vector<char> columns, rows;
+            size_t visibleCells = findVisibleLines(start.x, limit.x, columns) * findVisibleLines(start.y, limit.y, rows);
+            // look up the visible cells one by one when there are fewer of them than occupied chunks, otherwise filter the occupied chunks
+            if (visibleCells < chunks.getChunks().size()) {
+                for (size_t x = 0; x < chunkCount; x++)
+                {
+                    if (!columns[x])
+                        continue;
+                    for (size_t y = 0; y < chunkCount; y++)
+                    {
+                        const ChunkMap::Chunk* chunk = rows[y] ? chunks.find(ChunkMap::getKey(x, y)) : nullptr;
+                        if (chunk != nullptr)
+                            visibleChunks_.push_back(chunk);
+                    }
+                }
+            }
+            else {
+                for (auto&& chunk : chunks.getChunks()) {
+                    if (columns[ChunkMap::getChunkX(chunk.key)] && rows[ChunkMap::getChunkY(chunk.key)])
+                        visibleChunks_.push_back(&chunk);
+                }
+            }
+        }
+
+        visiblePositions_.resize(speciesCount);
+        std::vector<size_t> species(speciesCount);
+        std::iota(species.begin(), species.end(), 0);
+        std::for_each(std::execution::par, species.begin(), species.end(), [this, &particles, &chunks, culling, worldSize, start, limit, margins, extrapolation](size_t s)
+            {
+                std::vector<sf::Vector2f>& positions = visiblePositions_[s];
+                positions.clear();
+                // wrapping into the viewport also wraps particles extrapolated across the edge of the world
+                auto add = [&positions, worldSize, start, limit, margins, extrapolation](const Particle& particle) {
+                    sf::Vector2f position = particle.getPosition() + particle.getVelocity() * extrapolation;
+                    float x = position.x - start.x;
+                    float y = position.y - start.y;
+                    x -= worldSize * std::floor(x / worldSize);
+                    y -= worldSize * std::floor(y / worldSize);
+                    if (x < limit.x && y < limit.y)
+                        positions.emplace_back(x - margins.x, y - margins.y);
+                };
+                if (!culling) {
+                    for (auto&& p : particles[s])
+                        add(p);
+                    return;
+                }
+                const std::vector<Particle*>& chunkParticles = chunks.getParticles();
+                for (auto&& chunk : visibleChunks_) {
+                    for (size_t i = chunks.getBegin(*chunk, s); i < chunks.getEnd(*chunk, s); i++)
+                        add(*chunkParticles[i]);
+                }
+            });
+    }
+
+    void Renderer::renderParticlesAsPoints(const Viewport& viewport)
+    {
+        sf::VertexArray verts = sf::VertexArray();
+        for (size_t s = 0; s < visiblePositions_.size(); s++)
+        {
+            for (auto&& position : visiblePositions_[s]) {
+                verts.append(sf::Vertex(position * viewport.pixelsPerUnit + viewport.offset, options_.getSpecies(s).color));
+            }
+        }
+        if (verts.getVertexCount() > 0)
+            window_.draw(&verts[0], verts.getVertexCount(), sf::Points);
+    }
+
+    void Renderer::renderParticlesAsCircles(const Viewport& viewport)
+    {
+        float circleRadiusPx = options_.getParticleRadius() * viewport.pixelsPerUnit;
+        sf::Vector2f circleCenterOffset(-circleRadiusPx, -circleRadiusPx);
+        sf::CircleShape circle(circleRadiusPx, CIRCLE_POINTS);
+
+        for (size_t s = 0; s < visiblePositions_.size(); s++)
+        {
+            circle.setFillColor(options_.getSpecies(s).color);
+            for (auto&& position : visiblePositions_[s]) {
+                circle.setPosition(position * viewport.pixelsPerUnit + viewport.offset + circleCenterOffset);
+                window_.draw(circle);
+            }
+        }
+    }
+
+    void Renderer::renderParticlesAsDensity(const Viewport& viewport, size_t particleCount)
+    {
+        unsigned int width = (unsigned int)std::lround(viewport.span.x * viewport.pixelsPerUnit);
+        unsigned int height = (unsigned int)std::lround(viewport.span.y * viewport.pixelsPerUnit);
+        if (width == 0 || height == 0)
+            return;
+        float pixelsPerUnit = viewport.pixelsPerUnit;
+        size_t pixelCount = (size_t)width * height;
+        size_t speciesCount = visiblePositions_.size();
+        densityCounts_.assign(speciesCount * pixelCount, 0);
+        densityPixels_.resize(pixelCount * BYTES_PER_PIXEL);
+        if (densityTexture_.getSize() != sf::Vector2u(width, height))
+            densityTexture_.create(width, height);
+
+        std::vector<sf::Color> colors(speciesCount);
+        for (size_t s = 0; s < speciesCount; s++)
+        {
+            colors[s] = options_.getSpecies(s).color;
+            uint32_t* counts = densityCounts_.data() + s * pixelCount;
+            std::for_each(std::execution::par, visiblePositions_[s].begin(), visiblePositions_[s].end(), [counts, width, height, pixelsPerUnit](sf::Vector2f position)
+                {
+                    unsigned int x = std::min((unsigned int)(position.x * pixelsPerUnit), width - 1);
+                    unsigned int y = std::min((unsigned int)(position.y * pixelsPerUnit), height - 1);
+                    std::atomic_ref<uint32_t>(counts[(size_t)y * width + x]).fetch_add(1, std::memory_order_relaxed);
+                });
+        }
+
+        // brightness grows with the logarithm of the particle count, so both sparse and crowded areas stay distinguishable
+        // measured against the average density of the whole world, so that zooming doesn't change the brightness of an area
+        float worldPixels = options_.getWorldSize() * pixelsPerUnit * options_.getWorldSize() * pixelsPerUnit;
+        float saturation = std::log1p(std::max(1.0f, DENSITY_SATURATION * particleCount / worldPixels));
+        std::vector<unsigned int> rows(height);
+        std::iota(rows.begin(), rows.end(), 0);
+        std::for_each(std::execution::par, rows.begin(), rows.end(), [this, &colors, width, pixelCount, speciesCount, saturation](unsigned int y)
+            {
+                for (size_t pixel = (size_t)y * width; pixel < (size_t)(y + 1) * width; pixel++)
+                {
+                    float r = 0, g = 0, b = 0;
+                    uint32_t count = 0;
+                    for (size_t s = 0; s < speciesCount; s++)
+                    {
+                        uint32_t c = densityCounts_[s * pixelCount + pixel];
+                        r += (float)colors[s].r * c;
+                        g += (float)colors[s].g * c;
+                        b += (float)colors[s].b * c;
+                        count += c;
+                    }
+                    sf::Uint8* out = &densityPixels_[pixel * BYTES_PER_PIXEL];
+                    float brightness = count == 0 ? 0 : std::min(1.0f, std::log1p((float)count) / saturation) / count;
+                    out[0] = (sf::Uint8)(r * brightness);
+                    out[1] = (sf::Uint8)(g * brightness);
+                    out[2] = (sf::Uint8)(b * brightness);
+                    out[3] = 255;
+                }
+            });
+
+        densityTexture_.update(densityPixels_.data());
+        sf::Sprite sprite(densityTexture_);
+        sprite.setPosition(viewport.offset);
+        window_.draw(sprite);
+    }
+
+    void Renderer::renderText(size_t line, std::string text, bool alignRight) {
+        text_.setString(text);
+        float yPos = TEXT_LINE_HEIGHT * line + TEXT_PADDING;
+        if (alignRight) {
+            unsigned int windowWidth = window_.getSize().x;
+            auto textWidth = text_.getLocalBounds().width;
+            text_.setPosition(windowWidth - textWidth - TEXT_PADDING, yPos);
+        }
+        else {
+            text_.setPosition(TEXT_PADDING, yPos);
+        }
+        window_.draw(text_);
+    }
+    void Renderer::display() {
+        window_.display();
+    }
 }
\ No newline at end of file
@@ -1,37 +1,75 @@
-#ifndef RENDERER_H
-#define RENDERER_H
-#include "Options.h"
-#include "Particle.h"
-#include <SFML/Graphics.hpp>
-#include <vector>
-#include <string>
-namespace ParticleLife {
-    class Renderer {
-    private:
-        Options& options_;
-        sf::RenderWindow window_;
-        sf::Font font_;
-        sf::Text text_;
-        void renderParticlesAsPoints(const std::vector<std::vector<Particle>>& particles, float pixelsPerUnit, sf::Vector2f windowCenterOffset);
-        void renderParticlesAsCircles(const std::vector<std::vector<Particle>>& particles, float pixelsPerUnit, sf::Vector2f windowCenterOffset);
-    public:
-        Renderer(Options& options);
-        /// @brief initialize objects
-        void init();
-        /// @brief handle window events
-        void handleEvents();
-        /// @brief clear current frame buffer
-        void clear();
-        /// @brief draw particles onto current frame buffer
-        /// @param particles collection of particles of each particle species
-        void renderParticles(const std::vector<std::vector<Particle>>& particles);
-        /// @brief draw text onto current frame buffer
-        /// @param line line of text from the top of the stream
-        /// @param text text to display
-        /// @param alignRight align text to the right of the window
-        void renderText(size_t line, std::string text, bool alignRight);
-        /// @brief swap frame buffers (display new frame)
-        void display();
-    };
-}
+#ifndef RENDERER_H
+#define RENDERER_H
+#include "Options.h"
+#include "Particle.h"
+#include "ChunkMap.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+namespace ParticleLife {
+    class Renderer {
+    private:
+        /// @brief displayed part of the world and where it is in the window
+        struct Viewport {
+            /// @brief world coordinates of the top left corner of the displayed part, may lie outside of the world, which wraps around
+            sf::Vector2f origin;
+            /// @brief width and height of the displayed part in world units, at most the world size
+            sf::Vector2f span;
+            float pixelsPerUnit;
+            /// @brief window coordinates of the top left corner of the displayed part
+            sf::Vector2f offset;
+        };
+        Options& options_;
+        sf::RenderWindow window_;
+        sf::Font font_;
+        sf::Text text_;
+        /// @brief is the view being dragged by the mouse
+        bool dragging_;
+        /// @brief mouse position of the last drag event
+        sf::Vector2i dragPosition_;
+        /// @brief occupied chunks intersecting the viewport, reused between frames
+        std::vector<const ChunkMap::Chunk*> visibleChunks_;
+        /// @brief positions of displayed particles of each species relative to the viewport origin, reused between frames
+        std::vector<std::vector<sf::Vector2f>> visiblePositions_;
+        /// @brief particle count of each pixel of the density map, indexed by species * pixel count + pixel
+        std::vector<uint32_t> densityCounts_;
+        /// @brief colors of the density map, 4 bytes per pixel
+        std::vector<sf::Uint8> densityPixels_;
+        sf::Texture densityTexture_;
+        Viewport getViewport() const;
+        /// @brief zoom the view, keeping the world point under the mouse in place
+        /// @param delta mouse wheel ticks, positive to zoom in
+        void zoom(float delta, sf::Vector2i mousePosition);
+        /// @brief fill visiblePositions_ with particles in the viewport, only looking into chunks intersecting it
+        /// @param margin distance outside of the viewport at which particles are still displayed
+        /// @param extrapolation simulated time to move particles along their velocity
+        void collectVisibleParticles(const std::vector<ParticleVector>& particles, const ChunkMap& chunks, const Viewport& viewport, float margin, float extrapolation);
+        void renderParticlesAsPoints(const Viewport& viewport);
+        void renderParticlesAsCircles(const Viewport& viewport);
+        /// @brief count particles in each pixel in parallel and draw the counts as one texture
+        /// @param particleCount number of particles in the whole world
+        void renderParticlesAsDensity(const Viewport& viewport, size_t particleCount);
+    public:
+        Renderer(Options& options);
+        /// @brief initialize objects
+        void init();
+        /// @brief handle window events, the mouse wheel zooms and dragging with the left button pans the view
+        void handleEvents();
+        /// @brief clear current frame buffer
+        void clear();
+        /// @brief draw particles in the view onto current frame buffer
+        /// @param particles collection of particles of each particle species
+        /// @param chunks chunk map of the particles, used to skip chunks outside of the view if it contains all of them
+        /// @param extrapolation simulated time to move particles along their velocity, so that they are drawn between ticks
+        void renderParticles(const std::vector<ParticleVector>& particles, const ChunkMap& chunks, float extrapolation);
+        /// @brief draw text onto current frame buffer
+        /// @param line line of text from the top of the stream
+        /// @param text text to display
+        /// @param alignRight align text to the right of the window
+        void renderText(size_t line, std::string text, bool alignRight);
+        /// @brief swap frame buffers (display new frame)
+        void display();
+    };
+}
 #endif
\ No newline at end of file
@@ -1,173 +1,842 @@
-#include "Simulation.h"
-#include <iostream>
-#include <execution>
-#include <algorithm>
-namespace ParticleLife {
-    void Simulation::updateParticleCounts()
-    {
-        if (particles_.size() != options_.getSpeciesCount())
-            particles_.resize(options_.getSpeciesCount());
-        for (size_t s = 0; s < options_.getSpeciesCount(); s++)
-        {
-            if (particles_[s].size() > options_.getSpecies(s).count) {
-                particles_[s].resize(options_.getSpecies(s).count);
-            }
-            else {
-                while (particles_[s].size() < options_.getSpecies(s).count) {
-                    addParticle(s);
-                }
-            }
-        }
-    }
-
-    void Simulation::updateChunks() {
-        if (chunks_.size() != options_.getSpeciesCount())
-            chunks_.resize(options_.getSpeciesCount());
-        for (auto&& s : chunks_)
-        {
-            if (s.size() != options_.getChunkCount())
-                s.resize(options_.getChunkCount());
-            for (auto&& x : s)
-            {
-                if (x.size() != options_.getChunkCount())
-                    x.resize(options_.getChunkCount());
-                for (auto&& y : x)
-                {
-                    y.clear();
-                }
-            }
-        }
-        for (size_t s = 0; s < particles_.size(); s++)
-        {
-            for (auto&& p : particles_[s]) {
-                sf::Vector2u chunk = getChunk(p.getPosition());
-                chunks_[s][chunk.x][chunk.y].push_back(&p);
-            }
-        }
-    }
-
-    void Simulation::updateParticleForces()
-    {
-        std::vector<size_t> ss = {};
-        for (size_t i = 0; i < options_.getSpeciesCount(); i++)
-        {
-            ss.push_back(i);
-        }
-        std::for_each(
-            std::execution::par,
-            ss.begin(),
-            ss.end(),
-            [this](auto&& s)
-            {
-                for (size_t x = 0; x < options_.getChunkCount(); x++)
-                {
-                    for (size_t y = 0; y < options_.getChunkCount(); y++)
-                    {
-                        updateChunk(s, x, y);
-                    }
-                }
-            });
-    }
-
-    void Simulation::updateParticlePositions()
-    {
-        for (auto&& s : particles_) {
-            for (auto&& particle : s) {
-                particle.tick(options_.getTimeStep(), options_.getWorldSize(), options_.getFrictionMultiplierPerTick());
-            }
-        }
-    }
-
-    void Simulation::addParticle(size_t species) {
-        std::uniform_real_distribution<float> distribution(0, options_.getWorldSize());
-        particles_[species].emplace_back(sf::Vector2f(distribution(options_.random), distribution(options_.random)));
-    }
-
-    sf::Vector2u Simulation::getChunk(sf::Vector2f pos) {
-        sf::Vector2u chunk = sf::Vector2u((unsigned int)std::floorf(pos.x / options_.getChunkSize()), (unsigned int)std::floorf(pos.y / options_.getChunkSize()));
-        if (chunk.x >= options_.getChunkCount())
-            chunk.x = (unsigned int)options_.getChunkCount() - 1;
-        if (chunk.y >= options_.getChunkCount())
-            chunk.y = (unsigned int)options_.getChunkCount() - 1;
-        return chunk;
-    }
-
-    void Simulation::updateChunk(size_t species, size_t chunkX, size_t chunkY) {
-        for (size_t otherSpecies = 0; otherSpecies < options_.getSpeciesCount(); otherSpecies++) {
-            updateChunk(species, chunkX, chunkY, otherSpecies, 0, 0);
-            size_t chunkRange = options_.getSpecies(species).chunkRange[otherSpecies];
-            for (size_t i = 0; i < chunkRange; i++)
-            {
-                sf::Vector2u offset = options_.getChunkPattern()[i];
-                updateChunk(species, chunkX, chunkY, otherSpecies, offset.x, offset.y);
-                updateChunk(species, chunkX, chunkY, otherSpecies, offset.y, options_.getChunkCount() - offset.x);
-                updateChunk(species, chunkX, chunkY, otherSpecies, options_.getChunkCount() - offset.x, options_.getChunkCount() - offset.y);
-                updateChunk(species, chunkX, chunkY, otherSpecies, options_.getChunkCount() - offset.y, offset.x);
-            }
-        }
-    }
-    void Simulation::updateChunk(size_t species, size_t chunkX, size_t chunkY, size_t otherSpecies, size_t offsetX, size_t offsetY) {
-        for (auto&& particle : chunks_[species][chunkX][chunkY])
-        {
-            for (auto&& otherParticle : chunks_[otherSpecies][(chunkX + offsetX) % options_.getChunkCount()][(chunkY + offsetY) % options_.getChunkCount()]) {
-                updateParticle(*particle, options_.getSpecies(species), otherParticle->getPosition(), otherSpecies);
-            }
-        }
-    }
-    void Simulation::updateParticle(Particle& particle, const ParticleSpecies& species, sf::Vector2f otherPos, size_t otherSpecies) {
-        if (particle.getPosition() == otherPos)
-            return;
-
-        sf::Vector2f diff = otherPos - particle.getPosition();
-        float halfWorldSize = options_.getWorldSize() / 2;
-        if (diff.x < -halfWorldSize)
-            diff.x += options_.getWorldSize();
-        else if (diff.x > halfWorldSize)
-            diff.x -= options_.getWorldSize();
-        if (diff.y < -halfWorldSize)
-            diff.y += options_.getWorldSize();
-        else if (diff.y > halfWorldSize)
-            diff.y -= options_.getWorldSize();
-
-        float distanceSquared = diff.x * diff.x + diff.y * diff.y;
-
-        if (distanceSquared >= species.attractionRange[otherSpecies] * species.attractionRange[otherSpecies])
-            return;
-
-        float distance = std::sqrtf(distanceSquared);
-        float forceMagnitude = 0;
-        float peak = (species.attractionRange[otherSpecies] + species.repulsionRange[otherSpecies]) / 2;
-        float attractionChange = species.attraction[otherSpecies] / (peak - species.repulsionRange[otherSpecies]);
-
-        if (distance < species.repulsionRange[otherSpecies]) {
-            float overlap = 1 - distance / species.repulsionRange[otherSpecies];
-            forceMagnitude = -options_.getRepulsion() * overlap * overlap;
-        }
-        else if (distance < peak) {
-            forceMagnitude = (distance - species.repulsionRange[otherSpecies]) * attractionChange;
-        }
-        else {
-            forceMagnitude = (species.attractionRange[otherSpecies] - distance) * attractionChange;
-        }
-
-        sf::Vector2f direction = diff / distance;
-        particle.addForce(direction * forceMagnitude);
-    }
-
-
-    Simulation::Simulation(Options& options) :
-        options_(options), simTime_(0), particles_(), chunks_() {}
-
-    void Simulation::init()
-    {
-        updateParticleCounts();
-    }
-
-    void Simulation::tick() {
-        simTime_ += options_.getTimeStep();
-        updateParticleCounts();
-        updateChunks();
-        updateParticleForces();
-        updateParticlePositions();
-    }
+#include "Simulation.h"
+#include "ValueParser.h"
+#include <iostream>
+#include <execution>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <new>
+#include <bit>
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <chrono>
+namespace ParticleLife {
+    /// @brief portion of particles which may be scattered in memory away from the rest of their chunk before they are reordered
+    constexpr float REORDER_THRESHOLD = 0.25f;
+    /// @brief only the top 24 bits of a random number fit into a float in [0, 1) without rounding
+    constexpr int RANDOM_FLOAT_SHIFT = 40;
+    constexpr float RANDOM_FLOAT_SCALE = 1.0f / (1 << 24);
+    /// @brief the force pass is compiled separately for each species count up to this one, more species use a generic version
+    constexpr size_t MAX_SPECIALIZED_SPECIES = 16;
+    /// @brief particles of the chunks of one tile, the tile is cut once it has at least this many,
+    /// so that its positions together with the chunks within its reach stay in the L2 cache
+    constexpr size_t TILE_PARTICLES = 2048;
+
+    /// @brief counter based random number generator (SplitMix64 finalizer), maps each input to a well scrambled output
+    static uint64_t mixBits(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    void Simulation::updateParticleCounts()
+    {
+        if (particles_.size() != parameters_->species.size()) {
+            particles_.resize(parameters_->species.size());
+            ids_.resize(parameters_->species.size());
+        }
+        for (size_t s = 0; s < parameters_->species.size(); s++)
+        {
+            size_t count = particles_[s].size();
+            if (count > parameters_->species[s].count) {
+                removeParticles(s, parameters_->species[s].count);
+            }
+            else if (count < parameters_->species[s].count) {
+                particles_[s].resize(parameters_->species[s].count);
+                if (parameters_->threadPlacement == ThreadPlacement::PinnedHugePages)
+                    WorkerPool::adviseHugePages(particles_[s].data(), particles_[s].size() * sizeof(Particle));
+                ids_[s].resize(parameters_->species[s].count);
+                std::iota(ids_[s].begin() + count, ids_[s].end(), count);
+                spawnParticles(s, count);
+            }
+        }
+    }
+
+    void Simulation::removeParticles(size_t species, size_t count) {
+        ParticleVector& particles = particles_[species];
+        ParticleIdVector& ids = ids_[species];
+        size_t kept = 0;
+        for (size_t i = 0; i < particles.size(); i++)
+        {
+            if (ids[i] < count) {
+                particles[kept] = particles[i];
+                ids[kept] = ids[i];
+                kept++;
+            }
+        }
+        particles.resize(count);
+        ids.resize(count);
+    }
+
+    void Simulation::updateWorkers() {
+        size_t count = 0;
+        if (parameters_->parallel)
+            count = parameters_->threadCount == 0 ? std::max(1u, std::thread::hardware_concurrency()) : parameters_->threadCount;
+        if (!workers_.resize(count, parameters_->threadPlacement))
+            std::cout << ERROR_TAG << "Cannot pin some threads to cores, they are scheduled freely." << std::endl;
+    }
+
+    void Simulation::updateChunks() {
+        chunks_.build(particles_, *parameters_);
+        updateRegions();
+        if (!parameters_->reordering)
+            return;
+        size_t total = 0;
+        for (auto&& s : particles_)
+            total += s.size();
+        if (chunks_.countScattered() > total * REORDER_THRESHOLD)
+            reorderParticles();
+    }
+
+    void Simulation::reorderParticles() {
+        const std::vector<ChunkMap::Chunk>& chunks = chunks_.getChunks();
+        const std::vector<Particle*>& chunkParticles = chunks_.getParticles();
+        size_t speciesCount = particles_.size();
+        // index of the first particle of each region and species in the new order
+        std::vector<size_t> offsets(regions_.size() * speciesCount);
+        std::vector<size_t> next(speciesCount, 0);
+        for (size_t r = 0; r < regions_.size(); r++)
+        {
+            for (size_t s = 0; s < speciesCount; s++)
+            {
+                offsets[r * speciesCount + s] = next[s];
+                for (size_t c = regions_[r].chunkBegin; c < regions_[r].chunkEnd; c++)
+                {
+                    next[s] += chunks_.getEnd(chunks[c], s) - chunks_.getBegin(chunks[c], s);
+                }
+            }
+        }
+
+        std::vector<ParticleVector> particles(speciesCount);
+        std::vector<ParticleIdVector> ids(speciesCount);
+        std::vector<RestVector> rests(rests_.size());
+        for (size_t s = 0; s < speciesCount; s++)
+        {
+            particles[s].resize(particles_[s].size());
+            ids[s].resize(particles_[s].size());
+            if (!rests_.empty())
+                rests[s].resize(particles_[s].size());
+            if (parameters_->threadPlacement == ThreadPlacement::PinnedHugePages)
+                WorkerPool::adviseHugePages(particles[s].data(), particles[s].size() * sizeof(Particle));
+        }
+        // each region is copied by the worker which updates it, so its memory pages, including those of ids and rests, are first touched by (and placed next to) that worker
+        workers_.run(regions_.size(), [&](size_t r)
+        {
+            for (size_t s = 0; s < speciesCount; s++)
+            {
+                size_t next = offsets[r * speciesCount + s];
+                for (size_t c = regions_[r].chunkBegin; c < regions_[r].chunkEnd; c++)
+                {
+                    for (size_t i = chunks_.getBegin(chunks[c], s); i < chunks_.getEnd(chunks[c], s); i++)
+                    {
+                        size_t index = chunkParticles[i] - particles_[s].data();
+                        new (&particles[s][next]) Particle(*chunkParticles[i]);
+                        ids[s][next] = ids_[s][index];
+                        if (!rests_.empty())
+                            rests[s][next] = rests_[s][index];
+                        next++;
+                    }
+                }
+            }
+        });
+        particles_ = std::move(particles);
+        ids_ = std::move(ids);
+        rests_ = std::move(rests);
+        chunks_.relocate(particles_);
+    }
+
+    void Simulation::updateRests() {
+        if (parameters_->quiescenceDistance == 0) {
+            quiescenceMode_ = QuiescenceMode::Off;
+            restParameters_.reset();
+            rests_.clear();
+            quiescenceReport_.reset();
+            previousChunks_.clear();
+            return;
+        }
+        // observation isn't logged, so it mustn't decide which forces are applied, or a replay would diverge
+        if (tickCount_ % parameters_->quiescenceRefreshInterval == 0)
+            quiescenceMode_ = QuiescenceMode::Refresh;
+        else
+            quiescenceMode_ = QuiescenceMode::Reuse;
+        resettingRests_ = false;
+        if (restParameters_ != nullptr && restParameters_->version == parameters_->version)
+            return;
+        // only a change of forces resets the rests, so that commands which aren't logged don't make a replay reuse different forces
+        bool sameForces = restParameters_ != nullptr && hasSameForces(*restParameters_, *parameters_);
+        restParameters_ = parameters_;
+        if (sameForces)
+            return;
+        resettingRests_ = true;
+        rests_.resize(particles_.size());
+        for (size_t s = 0; s < particles_.size(); s++)
+        {
+            rests_[s].resize(particles_[s].size());
+        }
+        reusedUpdates_ = 0;
+        totalUpdates_ = 0;
+        quiescenceReport_ = QuiescenceReport{ 0, 0, 2 * parameters_->quiescenceDistance, -1, 0, 0, 0, 0 };
+    }
+
+    bool Simulation::hasSameForces(const SimulationParameters& parameters, const SimulationParameters& other) {
+        if (parameters.worldSize != other.worldSize || parameters.repulsion != other.repulsion || parameters.forceLaw != other.forceLaw || parameters.tabulatedForces != other.tabulatedForces)
+            return false;
+        if (parameters.quiescenceDistance != other.quiescenceDistance || parameters.quiescenceTicks != other.quiescenceTicks)
+            return false;
+        if (parameters.species.size() != other.species.size())
+            return false;
+        for (size_t s = 0; s < parameters.species.size(); s++)
+        {
+            const ParticleSpecies& species = parameters.species[s];
+            const ParticleSpecies& otherSpecies = other.species[s];
+            if (species.count != otherSpecies.count || species.repulsionRange != otherSpecies.repulsionRange || species.attraction != otherSpecies.attraction || species.attractionRange != otherSpecies.attractionRange)
+                return false;
+        }
+        return true;
+    }
+
+    void Simulation::updateQuietChunks() {
+        if (quiescenceMode_ == QuiescenceMode::Off)
+            return;
+        const std::vector<ChunkMap::Chunk>& chunks = chunks_.getChunks();
+        const std::vector<Particle*>& particles = chunks_.getParticles();
+        size_t speciesCount = parameters_->species.size();
+        quietChunks_.assign(chunks.size(), false);
+        reusableChunks_.assign(chunks.size(), false);
+        regionQuiescence_.assign(regions_.size(), QuiescenceCounts{ 0, 0, 0, 0, 0 });
+        float distanceSquared = parameters_->quiescenceDistance * parameters_->quiescenceDistance;
+        float worldSize = parameters_->worldSize;
+        workers_.run(regions_.size(), [&](size_t r)
+        {
+            for (size_t c = regions_[r].chunkBegin; c < regions_[r].chunkEnd; c++)
+            {
+                bool quiet = true;
+                for (size_t s = 0; s < speciesCount; s++)
+                {
+                    for (size_t i = chunks_.getBegin(chunks[c], s); i < chunks_.getEnd(chunks[c], s); i++)
+                    {
+                        sf::Vector2f position = particles[i]->getPosition();
+                        ParticleRest& rest = rests_[s][particles[i] - particles_[s].data()];
+                        // rests are unset until they are reset, so they are read only after that
+                        bool moved = resettingRests_;
+                        if (!moved) {
+                            sf::Vector2f diff = position - rest.anchor;
+                            diff.x -= worldSize * std::roundf(diff.x / worldSize);
+                            diff.y -= worldSize * std::roundf(diff.y / worldSize);
+                            moved = diff.x * diff.x + diff.y * diff.y > distanceSquared;
+                        }
+                        // a particle which moved too far settles again where it is, its forces are then recomputed for at least quiescenceTicks ticks
+                        if (moved)
+                            rest = { position, 0, sf::Vector2f() };
+                        else {
+                            rest.ticks++;
+                            rest.accelerationSum += particles[i]->getAcceleration();
+                        }
+                        quiet = quiet && rest.ticks >= parameters_->quiescenceTicks;
+                    }
+                }
+                quietChunks_[c] = quiet;
+            }
+        });
+
+        // particles moving between chunks change forces around both of them, even if they moved only a little
+        disturbedChunks_.assign(chunks.size(), false);
+        if (previousChunkCount_ != parameters_->chunkCount)
+            previousChunks_.clear();
+        std::vector<char> unchanged(chunks.size(), false);
+        size_t current = 0;
+        for (auto&& previous : previousChunks_) {
+            while (current < chunks.size() && chunks[current].key < previous.key)
+                current++;
+            if (current < chunks.size() && chunks[current].key == previous.key) {
+                unchanged[current] = chunks_.getEnd(chunks[current], speciesCount - 1) - chunks_.getBegin(chunks[current], 0) == previous.particleCount;
+                continue;
+            }
+            // a chunk which got empty isn't in the chunk map, so it can't be found as a chunk within reach which isn't quiet
+            ChunkMap::Chunk vacated = { previous.key, 0 };
+            for (size_t i = 0; i < maxChunkRange_; i++)
+            {
+                const ChunkMap::Chunk* others[ChunkMap::ROTATIONS];
+                chunks_.findRotations(vacated, parameters_->chunkPattern[i], parameters_->chunkCount, others);
+                for (auto&& other : others) {
+                    if (other != nullptr)
+                        disturbedChunks_[other - chunks.data()] = true;
+                }
+            }
+        }
+        previousChunks_.clear();
+        for (size_t c = 0; c < chunks.size(); c++)
+        {
+            quietChunks_[c] = quietChunks_[c] && unchanged[c];
+            previousChunks_.push_back({ chunks[c].key, chunks_.getEnd(chunks[c], speciesCount - 1) - chunks_.getBegin(chunks[c], 0) });
+        }
+        previousChunkCount_ = parameters_->chunkCount;
+    }
+
+    void Simulation::updateQuiescenceReport() {
+        if (quiescenceMode_ == QuiescenceMode::Off)
+            return;
+        QuiescenceCounts total{ 0, 0, 0, 0, 0 };
+        for (auto&& counts : regionQuiescence_) {
+            total.reused += counts.reused;
+            total.sampled += counts.sampled;
+            total.errorSum += counts.errorSum;
+            total.accelerationSum += counts.accelerationSum;
+            total.maxError = std::max(total.maxError, counts.maxError);
+        }
+        size_t particleCount = chunks_.getParticles().size();
+        reusedUpdates_ += total.reused;
+        totalUpdates_ += particleCount;
+        QuiescenceReport& report = *quiescenceReport_;
+        report.lastReused = particleCount == 0 ? 0 : (double)total.reused / particleCount;
+        report.totalReused = totalUpdates_ == 0 ? 0 : (double)reusedUpdates_ / totalUpdates_;
+        if (quiescenceMode_ != QuiescenceMode::Refresh)
+            return;
+        report.refreshTime = simTime_;
+        report.sampledParticles = total.sampled;
+        report.maxError = total.maxError;
+        report.meanError = total.sampled == 0 ? 0 : (float)(total.errorSum / total.sampled);
+        report.meanAcceleration = total.sampled == 0 ? 0 : (float)(total.accelerationSum / total.sampled);
+    }
+
+    void Simulation::updateRegions() {
+        const std::vector<ChunkMap::Chunk>& chunks = chunks_.getChunks();
+        size_t regionCount = std::max((size_t)1, workers_.getThreadCount());
+        size_t total = chunks_.getParticles().size();
+        regions_.clear();
+        chunkRegions_.resize(chunks.size());
+        size_t begin = 0;
+        size_t particles = 0;
+        for (size_t c = 0; c < chunks.size(); c++)
+        {
+            particles += chunks_.getEnd(chunks[c], parameters_->species.size() - 1) - chunks_.getBegin(chunks[c], 0);
+            chunkRegions_[c] = regions_.size();
+            // cut the region once it has its share of particles
+            if (particles * regionCount >= total * (regions_.size() + 1)) {
+                regions_.push_back({ begin, c + 1 });
+                begin = c + 1;
+            }
+        }
+        if (begin < chunks.size())
+            regions_.push_back({ begin, chunks.size() });
+    }
+
+    void Simulation::updateParticles() {
+        size_t regionCount = regions_.size();
+        regionReads_.assign(regionCount * regionCount, false);
+        if (tileBuffers_.size() < regionCount)
+            tileBuffers_.resize(regionCount);
+        if (observing_) {
+            regionObservables_.resize(regionCount);
+            for (auto&& o : regionObservables_) {
+                o.reset(parameters_->species.size());
+            }
+        }
+        if (workers_.getThreadCount() == 0) {
+            for (size_t r = 0; r < regionCount; r++)
+                (this->*regionForces_)(r);
+            for (size_t r = 0; r < regionCount; r++)
+                updateRegionPositions(r);
+            return;
+        }
+        regionsPending_ = std::vector<std::atomic<ptrdiff_t>>(regionCount);
+        // there are never more regions than workers, so every region has its own worker and waiting for other regions can't deadlock
+        workers_.run(regionCount, [this](size_t r) { updateRegion(r); });
+    }
+
+    void Simulation::updateRegion(size_t region) {
+        size_t regionCount = regions_.size();
+        (this->*regionForces_)(region);
+        // a region reads another one exactly when the other one reads it, so the regions read by this one are the ones it has to wait for
+        ptrdiff_t readers = std::count(regionReads_.begin() + region * regionCount, regionReads_.begin() + (region + 1) * regionCount, true);
+        if (regionsPending_[region].fetch_add(readers) + readers == 0)
+            regionsPending_[region].notify_all();
+        for (size_t r = 0; r < regionCount; r++)
+        {
+            if (regionReads_[region * regionCount + r] && regionsPending_[r].fetch_sub(1) - 1 == 0)
+                regionsPending_[r].notify_all();
+        }
+        ptrdiff_t pending;
+        while ((pending = regionsPending_[region].load()) != 0)
+            regionsPending_[region].wait(pending);
+        updateRegionPositions(region);
+    }
+
+    template <class Law, size_t SpeciesCount>
+    void Simulation::updateRegionForces(size_t region) {
+        const Interaction* interactions = interactions_.data();
+        // with a known species count, the interaction matrix is copied into a fixed size array on the worker's own stack,
+        // every index into it is computed at compile time once the species loops are unrolled
+        std::array<Interaction, SpeciesCount * SpeciesCount> table;
+        if constexpr (SpeciesCount > 0) {
+            std::copy(interactions_.begin(), interactions_.end(), table.begin());
+            interactions = table.data();
+        }
+        TickObservables* observables = observing_ ? &regionObservables_[region] : nullptr;
+        QuiescenceCounts* quiescence = quiescenceMode_ == QuiescenceMode::Refresh ? &regionQuiescence_[region] : nullptr;
+        TileBuffer& tile = tileBuffers_[region];
+        size_t c = regions_[region].chunkBegin;
+        while (c < regions_[region].chunkEnd) {
+            c = stageTile(c, region, tile);
+            updateTile<Law, SpeciesCount>(tile, interactions, observables, quiescence);
+        }
+    }
+
+    size_t Simulation::stageTile(size_t begin, size_t region, TileBuffer& tile) {
+        const std::vector<ChunkMap::Chunk>& chunks = chunks_.getChunks();
+        const std::vector<Particle*>& particles = chunks_.getParticles();
+        size_t speciesCount = parameters_->species.size();
+        size_t end = begin;
+        size_t particleCount = 0;
+        // consecutive chunks along the Z-order curve form compact blocks, so their reaches overlap
+        while (end < regions_[region].chunkEnd && (end == begin || particleCount < TILE_PARTICLES)) {
+            particleCount += chunks_.getEnd(chunks[end], speciesCount - 1) - chunks_.getBegin(chunks[end], 0);
+            end++;
+        }
+
+        // links hold chunk indices until the chunks get their slots
+        tile.links.clear();
+        char* reads = &regionReads_[region * regions_.size()];
+        for (size_t c = begin; c < end; c++)
+        {
+            const ChunkMap::Chunk& chunk = chunks[c];
+            size_t chunkRange = 0;
+            for (size_t s = 0; s < speciesCount; s++)
+            {
+                if (chunks_.getBegin(chunk, s) != chunks_.getEnd(chunk, s))
+                    chunkRange = std::max(chunkRange, maxChunkRanges_[s]);
+            }
+            // forces are reused only if no particle which could affect them moved, so all chunks within reach have to be quiet too
+            bool reusable = quiescenceMode_ != QuiescenceMode::Off && quietChunks_[c] && !disturbedChunks_[c];
+            size_t firstLink = tile.links.size();
+            reads[chunkRegions_[c]] = true;
+            tile.links.push_back({ c, c, 0 });
+            // chunks up to the largest range of all species are visited, so that the chunks read by this one are exactly the ones which read it
+            for (size_t i = 0; i < maxChunkRange_; i++)
+            {
+                const ChunkMap::Chunk* others[ChunkMap::ROTATIONS];
+                chunks_.findRotations(chunk, parameters_->chunkPattern[i], parameters_->chunkCount, others);
+                for (auto&& other : others) {
+                    if (other == nullptr)
+                        continue;
+                    size_t o = other - chunks.data();
+                    reads[chunkRegions_[o]] = true;
+                    reusable = reusable && quietChunks_[o];
+                    // chunks whose particles are all out of reach of each other are neither linked nor staged
+                    if (i < chunkRange && ChunkMap::getDistanceSquared(chunks_.getBox(chunk), chunks_.getBox(*other), parameters_->worldSize) < maxAttractionRangeSquared_)
+                        tile.links.push_back({ c, o, i + 1 });
+                }
+            }
+            if (!reusable)
+                continue;
+            // settled particles keep oscillating, so their momentary acceleration would push them one way until they leave, the mean one while at rest doesn't
+            for (size_t s = 0; s < speciesCount; s++)
+            {
+                for (size_t i = chunks_.getBegin(chunk, s); i < chunks_.getEnd(chunk, s); i++)
+                {
+                    const ParticleRest& rest = rests_[s][particles[i] - particles_[s].data()];
+                    particles[i]->setAcceleration(rest.accelerationSum / (float)rest.ticks);
+                }
+            }
+            reusableChunks_[c] = true;
+            if (quiescenceMode_ == QuiescenceMode::Reuse)
+                regionQuiescence_[region].reused += chunks_.getEnd(chunk, speciesCount - 1) - chunks_.getBegin(chunk, 0);
+            // reads stay marked, as the regions have to read each other symmetrically,
+            // the links are kept while observing, as observables count the pairs of all particles
+            if (quiescenceMode_ == QuiescenceMode::Reuse && !observing_)
+                tile.links.resize(firstLink);
+        }
+
+        tile.chunks.clear();
+        for (auto&& link : tile.links) {
+            tile.chunks.push_back(link.other);
+        }
+        std::sort(tile.chunks.begin(), tile.chunks.end());
+        tile.chunks.erase(std::unique(tile.chunks.begin(), tile.chunks.end()), tile.chunks.end());
+        auto slot = [&tile](size_t chunk) { return (size_t)(std::lower_bound(tile.chunks.begin(), tile.chunks.end(), chunk) - tile.chunks.begin()); };
+        for (auto&& link : tile.links) {
+            link.chunk = slot(link.chunk);
+            link.other = slot(link.other);
+        }
+
+        tile.offsets.resize(tile.chunks.size() + 1);
+        tile.positions.clear();
+        for (size_t k = 0; k < tile.chunks.size(); k++)
+        {
+            const ChunkMap::Chunk& chunk = chunks[tile.chunks[k]];
+            tile.offsets[k] = tile.positions.size();
+            for (size_t i = chunks_.getBegin(chunk, 0); i < chunks_.getEnd(chunk, speciesCount - 1); i++)
+            {
+                tile.positions.push_back(particles[i]->getPosition());
+            }
+        }
+        tile.offsets[tile.chunks.size()] = tile.positions.size();
+        tile.forces.assign(tile.positions.size(), sf::Vector2f());
+        return end;
+    }
+
+    template <class Law, size_t SpeciesCount>
+    void Simulation::updateTile(TileBuffer& tile, const Interaction* interactions, TickObservables* observables, QuiescenceCounts* quiescence) {
+        const std::vector<ChunkMap::Chunk>& chunks = chunks_.getChunks();
+        size_t speciesCount = SpeciesCount > 0 ? SpeciesCount : parameters_->species.size();
+        const sf::Vector2f* positions = tile.positions.data();
+        sf::Vector2f* forces = tile.forces.data();
+        // the links of each chunk are in the order the chunks were visited before tiling, so each particle sums its forces in the same order
+        for (auto&& link : tile.links) {
+            const ChunkMap::Chunk& chunk = chunks[tile.chunks[link.chunk]];
+            const ChunkMap::Chunk& otherChunk = chunks[tile.chunks[link.other]];
+            // converts indices into the chunk map to indices into the tile
+            size_t shift = tile.offsets[link.chunk] - chunks_.getBegin(chunk, 0);
+            size_t otherShift = tile.offsets[link.other] - chunks_.getBegin(otherChunk, 0);
+            for (size_t s = 0; s < speciesCount; s++)
+            {
+                size_t begin = chunks_.getBegin(chunk, s) + shift;
+                size_t end = chunks_.getEnd(chunk, s) + shift;
+                if (begin == end)
+                    continue;
+                const ChunkMap::Box& box = chunks_.getBox(chunk, s);
+                for (size_t os = 0; os < speciesCount; os++)
+                {
+                    const Interaction& interaction = interactions[s * speciesCount + os];
+                    if (link.patternLength > interaction.chunkRange)
+                        continue;
+                    // the chunk range only bounds the distance of the chunks, the boxes of the species often show that no pair is within range
+                    if (link.patternLength > 0 && ChunkMap::getDistanceSquared(box, chunks_.getBox(otherChunk, os), parameters_->worldSize) >= interaction.attractionRangeSquared)
+                        continue;
+                    size_t otherBegin = chunks_.getBegin(otherChunk, os) + otherShift;
+                    size_t otherEnd = chunks_.getEnd(otherChunk, os) + otherShift;
+                    for (size_t i = begin; i < end; i++)
+                    {
+                        sf::Vector2f force = forces[i];
+                        for (size_t j = otherBegin; j < otherEnd; j++) {
+                            updateParticle<Law>(positions[i], force, interaction, positions[j], observables);
+                        }
+                        forces[i] = force;
+                    }
+                }
+            }
+        }
+
+        // each chunk of the tile whose forces aren't reused is linked to itself once
+        const std::vector<Particle*>& particles = chunks_.getParticles();
+        for (auto&& link : tile.links) {
+            if (link.patternLength != 0)
+                continue;
+            size_t c = tile.chunks[link.chunk];
+            // reused chunks are linked only while observing, their forces are computed just for the observables and keep their mean
+            if (quiescenceMode_ == QuiescenceMode::Reuse && reusableChunks_[c])
+                continue;
+            size_t shift = chunks_.getBegin(chunks[c], 0) - tile.offsets[link.chunk];
+            bool sampled = quiescence != nullptr && reusableChunks_[c];
+            for (size_t i = tile.offsets[link.chunk]; i < tile.offsets[link.chunk + 1]; i++)
+            {
+                Particle* particle = particles[i + shift];
+                if (sampled) {
+                    sf::Vector2f error = forces[i] - particle->getAcceleration();
+                    float errorLength = std::sqrtf(error.x * error.x + error.y * error.y);
+                    quiescence->sampled++;
+                    quiescence->errorSum += errorLength;
+                    quiescence->accelerationSum += std::sqrtf(forces[i].x * forces[i].x + forces[i].y * forces[i].y);
+                    quiescence->maxError = std::max(quiescence->maxError, errorLength);
+                }
+                particle->setAcceleration(forces[i]);
+            }
+        }
+    }
+
+    void Simulation::updateRegionPositions(size_t region) {
+        const std::vector<ChunkMap::Chunk>& chunks = chunks_.getChunks();
+        const std::vector<Particle*>& particles = chunks_.getParticles();
+        if (regions_[region].chunkBegin == regions_[region].chunkEnd)
+            return;
+        size_t begin = chunks_.getBegin(chunks[regions_[region].chunkBegin], 0);
+        size_t end = chunks_.getEnd(chunks[regions_[region].chunkEnd - 1], parameters_->species.size() - 1);
+        if (!observing_) {
+            for (size_t i = begin; i < end; i++)
+            {
+                particles[i]->tick(parameters_->timeStep, parameters_->worldSize, parameters_->frictionMultiplierPerTick);
+            }
+            return;
+        }
+        TickObservables& observables = regionObservables_[region];
+        for (size_t c = regions_[region].chunkBegin; c < regions_[region].chunkEnd; c++)
+        {
+            for (size_t s = 0; s < parameters_->species.size(); s++)
+            {
+                observables.particleCounts[s] += chunks_.getEnd(chunks[c], s) - chunks_.getBegin(chunks[c], s);
+                for (size_t i = chunks_.getBegin(chunks[c], s); i < chunks_.getEnd(chunks[c], s); i++)
+                {
+                    particles[i]->tick(parameters_->timeStep, parameters_->worldSize, parameters_->frictionMultiplierPerTick);
+                    sf::Vector2f v = particles[i]->getVelocity();
+                    observables.kineticEnergy[s] += (v.x * v.x + v.y * v.y) / 2;
+                }
+            }
+        }
+    }
+
+    void Simulation::updateObservables() {
+        size_t speciesCount = parameters_->species.size();
+        TickObservables observables;
+        observables.reset(speciesCount);
+        for (auto&& o : regionObservables_) {
+            observables.add(o);
+        }
+        observables.time = simTime_;
+        observables.worldSize = parameters_->worldSize;
+        for (size_t pair = 0; pair < speciesCount * speciesCount; pair++)
+        {
+            observables.attractionRanges[pair] = interactions_[pair].attractionRange;
+        }
+        observablesWriter_.submit(std::move(observables));
+    }
+
+    void Simulation::spawnParticles(size_t species, size_t first) {
+        auto spawn = [this, species](auto&& p)
+        {
+            size_t index = &p - particles_[species].data();
+            new (&p) Particle(getSpawnPosition(species, ids_[species][index]));
+        };
+        if (parameters_->parallel)
+            std::for_each(std::execution::par, particles_[species].begin() + first, particles_[species].end(), spawn);
+        else
+            std::for_each(std::execution::seq, particles_[species].begin() + first, particles_[species].end(), spawn);
+    }
+
+    sf::Vector2f Simulation::getSpawnPosition(size_t species, size_t id) const {
+        uint64_t key = parameters_->seed ^ mixBits(species + 1);
+        float x = (mixBits(key ^ (2 * id)) >> RANDOM_FLOAT_SHIFT) * RANDOM_FLOAT_SCALE;
+        float y = (mixBits(key ^ (2 * id + 1)) >> RANDOM_FLOAT_SHIFT) * RANDOM_FLOAT_SCALE;
+        return sf::Vector2f(x, y) * parameters_->worldSize;
+    }
+
+    void Simulation::updateInteractions() {
+        size_t speciesCount = parameters_->species.size();
+        interactions_.resize(speciesCount * speciesCount);
+        maxChunkRanges_.assign(speciesCount, 0);
+        maxChunkRange_ = 0;
+        maxAttractionRangeSquared_ = 0;
+        for (size_t s = 0; s < speciesCount; s++)
+        {
+            const ParticleSpecies& species = parameters_->species[s];
+            for (size_t os = 0; os < speciesCount; os++)
+            {
+                Interaction& interaction = interactions_[s * speciesCount + os];
+                interaction.repulsionRange = species.repulsionRange[os];
+                interaction.attractionRange = species.attractionRange[os];
+                interaction.attractionRangeSquared = interaction.attractionRange * interaction.attractionRange;
+                interaction.peak = (interaction.attractionRange + interaction.repulsionRange) / 2;
+                interaction.attraction = species.attraction[os];
+                interaction.attractionChange = species.attraction[os] / (interaction.peak - interaction.repulsionRange);
+                interaction.halfWidthInverse = 1 / (interaction.peak - interaction.repulsionRange);
+                interaction.widthInverse = 1 / (interaction.attractionRange - interaction.repulsionRange);
+                interaction.chunkRange = species.chunkRange[os];
+                interaction.pair = s * speciesCount + os;
+                interaction.forceTable = nullptr;
+                interaction.forceTableScale = 0;
+                maxChunkRanges_[s] = std::max(maxChunkRanges_[s], interaction.chunkRange);
+                maxChunkRange_ = std::max(maxChunkRange_, interaction.chunkRange);
+                maxAttractionRangeSquared_ = std::max(maxAttractionRangeSquared_, interaction.attractionRangeSquared);
+            }
+        }
+        forceTables_.clear();
+        switch (parameters_->forceLaw)
+        {
+        case ForceLaw::PiecewiseLinear:
+            regionForces_ = selectRegionForces<PiecewiseLinearForce>(speciesCount);
+            if (parameters_->tabulatedForces)
+                updateForceTables<PiecewiseLinearForce>();
+            break;
+        case ForceLaw::SmoothCubic:
+            regionForces_ = selectRegionForces<SmoothCubicForce>(speciesCount);
+            if (parameters_->tabulatedForces)
+                updateForceTables<SmoothCubicForce>();
+            break;
+        case ForceLaw::LennardJones:
+            regionForces_ = selectRegionForces<LennardJonesForce>(speciesCount);
+            if (parameters_->tabulatedForces)
+                updateForceTables<LennardJonesForce>();
+            break;
+        }
+        // the tables already contain the law
+        if (parameters_->tabulatedForces)
+            regionForces_ = selectRegionForces<TabulatedForce>(speciesCount);
+        interactionsVersion_ = parameters_->version;
+    }
+
+    template <class Law>
+    void Simulation::updateForceTables() {
+        constexpr size_t ENTRIES = TabulatedForce::TABLE_SIZE + 1;
+        forceTables_.resize(interactions_.size() * ENTRIES);
+        for (size_t pair = 0; pair < interactions_.size(); pair++)
+        {
+            Interaction& interaction = interactions_[pair];
+            interaction.forceTable = &forceTables_[pair * ENTRIES];
+            interaction.forceTableScale = TabulatedForce::TABLE_SIZE / interaction.attractionRangeSquared;
+            TabulatedForce::fill<Law>(&forceTables_[pair * ENTRIES], interaction, parameters_->repulsion);
+        }
+    }
+
+    template <class Law>
+    float Simulation::getForceTableError() const {
+        float maxError = 0;
+        for (auto&& interaction : interactions_) {
+            maxError = std::max(maxError, TabulatedForce::getMaxError<Law>(interaction, parameters_->repulsion));
+        }
+        return maxError;
+    }
+
+    float Simulation::getForceTableError() const {
+        if (forceTables_.empty())
+            return 0;
+        switch (parameters_->forceLaw)
+        {
+        case ForceLaw::SmoothCubic:
+            return getForceTableError<SmoothCubicForce>();
+        case ForceLaw::LennardJones:
+            return getForceTableError<LennardJonesForce>();
+        default:
+            return getForceTableError<PiecewiseLinearForce>();
+        }
+    }
+
+    template <class Law>
+    Simulation::RegionForces Simulation::selectRegionForces(size_t speciesCount) {
+        static constexpr auto kernels = []<size_t... Counts>(std::index_sequence<Counts...>) {
+            return std::array<RegionForces, sizeof...(Counts)>{ &Simulation::updateRegionForces<Law, Counts>... };
+        }(std::make_index_sequence<MAX_SPECIALIZED_SPECIES + 1>());
+        // kernel 0 is the generic one
+        return speciesCount < kernels.size() ? kernels[speciesCount] : kernels[0];
+    }
+
+    template <class Law>
+    void Simulation::updateParticle(sf::Vector2f position, sf::Vector2f& force, const Interaction& interaction, sf::Vector2f otherPos, TickObservables* observables) {
+        if (position == otherPos)
+            return;
+
+        sf::Vector2f diff = otherPos - position;
+        float halfWorldSize = parameters_->worldSize / 2;
+        if (diff.x < -halfWorldSize)
+            diff.x += parameters_->worldSize;
+        else if (diff.x > halfWorldSize)
+            diff.x -= parameters_->worldSize;
+        if (diff.y < -halfWorldSize)
+            diff.y += parameters_->worldSize;
+        else if (diff.y > halfWorldSize)
+            diff.y -= parameters_->worldSize;
+
+        float distanceSquared = diff.x * diff.x + diff.y * diff.y;
+
+        if (distanceSquared >= interaction.attractionRangeSquared)
+            return;
+
+        if constexpr (std::is_same_v<Law, TabulatedForce>) {
+            if (observables != nullptr) {
+                float distance = std::sqrtf(distanceSquared);
+                observables->addPair(interaction.pair, distance < interaction.repulsionRange, distance / interaction.attractionRange);
+            }
+            force += diff * TabulatedForce::getForceOverDistance(interaction, distanceSquared);
+        }
+        else {
+            float distance = std::sqrtf(distanceSquared);
+            if (observables != nullptr)
+                observables->addPair(interaction.pair, distance < interaction.repulsionRange, distance / interaction.attractionRange);
+
+            float forceMagnitude = Law::getForce(interaction, distance, parameters_->repulsion);
+
+            sf::Vector2f direction = diff / distance;
+            force += direction * forceMagnitude;
+        }
+    }
+
+
+    Simulation::Simulation(const Options& options) :
+        options_(options), parameters_(), interactionsVersion_(0), interactions_(), forceTables_(), maxChunkRanges_(), maxChunkRange_(0), maxAttractionRangeSquared_(0), simTime_(0), tickCount_(0), phaseTimes_(), particles_(), ids_(), chunks_(), regions_(), chunkRegions_(), regionReads_(), regionsPending_(), tileBuffers_(), workers_(), regionForces_(selectRegionForces<PiecewiseLinearForce>(0)), clusterAnalyzer_(), clusterReport_(), observing_(false), regionObservables_(), observablesFile_(), observablesWriter_(), sharedFramesName_(), framePublisher_(), quiescenceMode_(QuiescenceMode::Off), restParameters_(), resettingRests_(false), rests_(), quietChunks_(), disturbedChunks_(), reusableChunks_(), previousChunks_(), previousChunkCount_(0), regionQuiescence_(), reusedUpdates_(0), totalUpdates_(0), quiescenceReport_() {}
+
+    void Simulation::init()
+    {
+        parameters_ = options_.getParameters();
+        updateWorkers();
+        updateParticleCounts();
+    }
+
+    void Simulation::tick() {
+        auto start = std::chrono::steady_clock::now();
+        auto phaseStart = start;
+        // milliseconds since the previous call
+        auto lap = [&phaseStart]() {
+            auto now = std::chrono::steady_clock::now();
+            std::chrono::duration<double, std::milli> duration = now - phaseStart;
+            phaseStart = now;
+            return duration.count();
+        };
+        parameters_ = options_.getParameters();
+        if (interactionsVersion_ != parameters_->version)
+            updateInteractions();
+        updateWorkers();
+        updateParticleCounts();
+        observing_ = parameters_->observablesInterval > 0 && tickCount_ % parameters_->observablesInterval == 0;
+        updateRests();
+        if (observablesFile_ != parameters_->observablesFile) {
+            observablesFile_ = parameters_->observablesFile;
+            observablesWriter_.open(observablesFile_);
+        }
+        if (sharedFramesName_ != parameters_->sharedFramesName) {
+            sharedFramesName_ = parameters_->sharedFramesName;
+            if (!framePublisher_.open(sharedFramesName_, particles_))
+                std::cout << ERROR_TAG << "Cannot create shared memory \"" << sharedFramesName_ << "\"." << std::endl;
+        }
+        phaseTimes_.setup = lap();
+        updateChunks();
+        updateQuietChunks();
+        phaseTimes_.chunks = lap();
+        // clusters are found in a snapshot taken while the chunk map matches particle positions,
+        // a slice of its chunks is linked each tick, so the work is spread evenly over the interval
+        if (parameters_->clusterInterval == 0)
+            clusterAnalyzer_.stop();
+        else {
+            if (tickCount_ % parameters_->clusterInterval == 0) {
+                // an analysis left unfinished by a shortened interval is completed first
+                while (clusterAnalyzer_.isRunning()) {
+                    if (std::optional<ClusterReport> report = clusterAnalyzer_.advance(workers_))
+                        clusterReport_ = std::move(report);
+                }
+                clusterAnalyzer_.start(chunks_, parameters_, workers_, simTime_, parameters_->clusterInterval);
+            }
+            if (std::optional<ClusterReport> report = clusterAnalyzer_.advance(workers_))
+                clusterReport_ = std::move(report);
+        }
+        phaseTimes_.clusters = lap();
+        updateParticles();
+        updateQuiescenceReport();
+        phaseTimes_.particles = lap();
+        simTime_ += parameters_->timeStep;
+        if (observing_)
+            updateObservables();
+        tickCount_++;
+        // published after the tick, so external viewers see the same positions as the renderer
+        if (parameters_->sharedFramesInterval > 0 && tickCount_ % parameters_->sharedFramesInterval == 0 && !framePublisher_.publish(particles_, tickCount_, simTime_, parameters_->worldSize))
+            std::cout << ERROR_TAG << "Cannot grow shared memory \"" << sharedFramesName_ << "\", frames are no longer published." << std::endl;
+        std::chrono::duration<double, std::milli> total = std::chrono::steady_clock::now() - start;
+        phaseTimes_.total = total.count();
+    }
+
+    uint64_t Simulation::getStateChecksum() const
+    {
+        // FNV-1a over the bits of each coordinate
+        uint64_t hash = 0xcbf29ce484222325ull;
+        auto add = [&hash](float value) {
+            hash = (hash ^ std::bit_cast<uint32_t>(value)) * 0x100000001b3ull;
+        };
+        for (auto&& species : particles_) {
+            for (auto&& p : species) {
+                add(p.getPosition().x);
+                add(p.getPosition().y);
+                add(p.getVelocity().x);
+                add(p.getVelocity().y);
+            }
+        }
+        return hash;
+    }
 }
\ No newline at end of file
@@ -1,61 +1,338 @@
-#ifndef SIMULATION_H
-#define SIMULATION_H
-#include "Options.h"
-#include "Particle.h"
-#include <SFML/Graphics.hpp>
-#include <vector>
-namespace ParticleLife {
-    class Simulation {
-    private:
-        Options& options_;
-        /// @brief time simulated
-        double simTime_;
-        /// @brief particles split by species
-        std::vector<std::vector<Particle>> particles_;
-        /// @brief particles split by species, chunk x, chunk y
-        std::vector<std::vector<std::vector<std::vector<Particle*>>>> chunks_;
-        /// @brief create or destroy particles to match counts specified in options
-        void updateParticleCounts();
-        /// @brief assign particles to corresponding chunks
-        void updateChunks();
-        /// @brief update acceleration of each particle
-        void updateParticleForces();
-        /// @brief update velocity and position of each particle
-        void updateParticlePositions();
-        /// @brief add a particle of given species
-        /// @param species species id
-        void addParticle(size_t species);
-        /// @brief get coordinates of the chunk containing this world position
-        sf::Vector2u getChunk(sf::Vector2f pos);
-        /// @brief update acceleration of each particle of given species within given chunk
-        /// @param species species id
-        /// @param chunkX horizontal chunk coordinate
-        /// @param chunkY vertical chunk coordinate
-        void updateChunk(size_t species, size_t chunkX, size_t chunkY);
-        /// @brief update acceleration of each particle of given species within given chunk as affected by particles of other species within other given chunk
-        /// @param species affected species id
-        /// @param chunkX horizontal chunk coordinate
-        /// @param chunkY vertical chunk coordinate
-        /// @param otherSpecies other species id
-        /// @param offsetX horizontal offset of other chunk compared to initial chunk
-        /// @param offsetY vertical offset of other chunk compared to initial chunk
-        void updateChunk(size_t species, size_t chunkX, size_t chunkY, size_t otherSpecies, size_t offsetX, size_t offsetY);
-        /// @brief update acceleration of a given particle as affected by other particle
-        /// @param particle particle to update
-        /// @param species species of the given partcle
-        /// @param otherPos position of the other particle
-        /// @param otherSpecies species id of the other particle
-        void updateParticle(Particle& particle, const ParticleSpecies& species, sf::Vector2f otherPos, size_t otherSpecies);
-    public:
-        Simulation(Options& options);
-        /// @brief initialize simulation
-        void init();
-        /// @brief simulate one step of simulation
-        void tick();
-        /// @brief get time simulated
-        inline double getTime() const { return simTime_; }
-        /// @brief get particles split by species
-        inline const std::vector<std::vector<Particle>>& getParticles() const { return particles_; }
-    };
-}
+#ifndef SIMULATION_H
+#define SIMULATION_H
+#include "Options.h"
+#include "Particle.h"
+#include "ChunkMap.h"
+#include "WorkerPool.h"
+#include "ClusterAnalyzer.h"
+#include "ObservablesWriter.h"
+#include "FramePublisher.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <atomic>
+#include <optional>
+namespace ParticleLife {
+    /// @brief real time spent in each phase of one tick, in milliseconds
+    struct TickPhaseTimes {
+        /// @brief picking up changed options: interactions, worker threads and particle counts
+        double setup;
+        /// @brief assigning particles to chunks and regions, including reordering them
+        double chunks;
+        /// @brief cluster analysis, 0 if there was none this tick
+        double clusters;
+        /// @brief forces and movement of the particles
+        double particles;
+        /// @brief the whole tick
+        double total;
+    };
+
+    /// @brief work saved by reusing forces of chunks where particles settled, and the error it causes
+    struct QuiescenceReport {
+        /// @brief fraction of particles whose forces were reused during the last tick
+        double lastReused;
+        /// @brief fraction of particle updates with reused forces since the forces last changed
+        double totalReused;
+        /// @brief reused forces were computed while every particle within reach was at most this far from its current position
+        float maxDisplacement;
+        /// @brief simulated time of the last refresh, negative if there was none yet
+        double refreshTime;
+        /// @brief number of particles whose forces could have been reused during the last refresh
+        size_t sampledParticles;
+        /// @brief largest difference between the acceleration that would have been reused and the recomputed one during the last refresh
+        float maxError;
+        /// @brief mean difference between the accelerations that would have been reused and the recomputed ones during the last refresh
+        float meanError;
+        /// @brief mean magnitude of the recomputed accelerations the errors were measured on
+        float meanAcceleration;
+    };
+
+    /// @brief stable ids of the particles of one species, like ParticleVector left untouched by resize, so the worker filling them places their pages
+    using ParticleIdVector = std::vector<size_t, UninitializedAllocator<size_t>>;
+
+    class Simulation {
+    private:
+        /// @brief constants of the interaction of one species with another, derived from parameters
+        struct Interaction {
+            float repulsionRange;
+            float attractionRange;
+            float attractionRangeSquared;
+            /// @brief distance of the strongest attraction
+            float peak;
+            /// @brief peak attraction strength
+            float attraction;
+            /// @brief change of attraction strength per unit of distance
+            float attractionChange;
+            /// @brief 1 / (peak - repulsionRange)
+            float halfWidthInverse;
+            /// @brief 1 / (attractionRange - repulsionRange)
+            float widthInverse;
+            /// @brief TabulatedForce::TABLE_SIZE + 1 samples of force / distance, nullptr unless forces are tabulated
+            const float* forceTable;
+            /// @brief TabulatedForce::TABLE_SIZE / attractionRangeSquared, converts squared distance to table position
+            float forceTableScale;
+            /// @brief amount of closest chunks to check (in each direction) for particles which could be within attractionRange
+            size_t chunkRange;
+            /// @brief species id * species count + other species id
+            size_t pair;
+        };
+        /// @brief contiguous range of chunks owned by one task, all particles within are updated only by this task
+        struct Region {
+            /// @brief index of the first chunk of this region
+            size_t chunkBegin;
+            /// @brief index after the last chunk of this region
+            size_t chunkEnd;
+        };
+        /// @brief consecutive chunks of a region (a tile) together with the chunks within their reach, staged into contiguous buffers
+        /// @details positions of each staged chunk are copied once per tile instead of being read through particle pointers by every chunk which reaches it
+        struct TileBuffer {
+            /// @brief pair of staged chunks whose particles interact, in the order their forces are summed
+            struct Link {
+                /// @brief slot of the chunk of the tile whose particles are updated
+                size_t chunk;
+                /// @brief slot of the chunk within its reach
+                size_t other;
+                /// @brief how many first entries of the chunk pattern are needed to reach the other chunk, 0 if it is the same chunk
+                size_t patternLength;
+            };
+            /// @brief index of the chunk in each slot, sorted, so the chunks of the tile occupy consecutive slots
+            std::vector<size_t> chunks;
+            /// @brief index of the first position of each slot
+            std::vector<size_t> offsets;
+            /// @brief positions of the particles of all staged chunks, each chunk in the order of the chunk map
+            std::vector<sf::Vector2f> positions;
+            /// @brief forces summed for each particle of the tile, at the same indices as its position
+            std::vector<sf::Vector2f> forces;
+            std::vector<Link> links;
+        };
+
+        /// @brief whether forces of chunks where particles settled are reused during a tick
+        enum class QuiescenceMode {
+            /// @brief all forces are computed and nothing is tracked
+            Off,
+            /// @brief forces of quiet chunks are reused
+            Reuse,
+            /// @brief all forces are computed, the ones which could have been reused measure the error
+            Refresh
+        };
+        /// @brief where a particle settled and for how many ticks it has stayed within the quiescence distance of it
+        struct ParticleRest {
+            sf::Vector2f anchor;
+            size_t ticks;
+            /// @brief sum of the particle's accelerations during those ticks
+            sf::Vector2f accelerationSum;
+        };
+        /// @brief rests of the particles of one species, left untouched by resize, each rest is written before it is read
+        using RestVector = std::vector<ParticleRest, UninitializedAllocator<ParticleRest>>;
+        /// @brief occupied chunk of the previous tick
+        struct ChunkCount {
+            uint64_t key;
+            size_t particleCount;
+        };
+        /// @brief reused and measured forces of one region during one tick
+        struct QuiescenceCounts {
+            /// @brief particles whose forces were reused
+            size_t reused;
+            /// @brief particles whose recomputed forces were compared with the ones they would have reused
+            size_t sampled;
+            double errorSum;
+            double accelerationSum;
+            float maxError;
+        };
+
+        const Options& options_;
+        /// @brief options used during the current tick, picked up once at its start
+        std::shared_ptr<const SimulationParameters> parameters_;
+        /// @brief version of parameters the interactions were computed from
+        size_t interactionsVersion_;
+        /// @brief interactions indexed by species id * species count + other species id
+        std::vector<Interaction> interactions_;
+        /// @brief force tables of all interactions, in the order of interactions, empty unless forces are tabulated
+        std::vector<float> forceTables_;
+        /// @brief largest chunk range of each species
+        std::vector<size_t> maxChunkRanges_;
+        /// @brief largest chunk range of all species
+        size_t maxChunkRange_;
+        /// @brief square of the largest attraction range of all species
+        float maxAttractionRangeSquared_;
+        /// @brief time simulated
+        double simTime_;
+        /// @brief number of ticks simulated
+        size_t tickCount_;
+        /// @brief phase times of the last tick
+        TickPhaseTimes phaseTimes_;
+        /// @brief particles split by species, periodically reordered to follow the order of chunks
+        std::vector<ParticleVector> particles_;
+        /// @brief stable id of each particle, split by species, ids of each species are 0 to particle count - 1
+        std::vector<ParticleIdVector> ids_;
+        /// @brief particles split by chunk and species, only occupied chunks are stored
+        ChunkMap chunks_;
+        /// @brief the world split into regions with similar particle counts, chunks are ordered along the Z-order curve, so each region is compact
+        std::vector<Region> regions_;
+        /// @brief region of each chunk
+        std::vector<size_t> chunkRegions_;
+        /// @brief indexed by region * region count + other region, whether the region's forces read particles of the other region during this tick
+        std::vector<char> regionReads_;
+        /// @brief for each region, number of regions reading it which haven't finished their forces yet, minus the ones which finished before it knew their count
+        std::vector<std::atomic<ptrdiff_t>> regionsPending_;
+        /// @brief tile buffer of each region, kept between ticks to reuse its memory
+        std::vector<TileBuffer> tileBuffers_;
+        /// @brief worker threads, region i is always updated by worker i
+        WorkerPool workers_;
+        /// @brief force pass of one region
+        using RegionForces = void (Simulation::*)(size_t);
+        /// @brief updateRegionForces instantiated for the force law and species count of the current tick
+        RegionForces regionForces_;
+        ClusterAnalyzer clusterAnalyzer_;
+        /// @brief result of the last cluster analysis, empty if there was none yet
+        std::optional<ClusterReport> clusterReport_;
+        /// @brief are observables measured during this tick
+        bool observing_;
+        /// @brief observables measured by each region during this tick
+        std::vector<TickObservables> regionObservables_;
+        /// @brief file the observables writer was last asked to open
+        std::string observablesFile_;
+        ObservablesWriter observablesWriter_;
+        /// @brief shared memory region the frame publisher was last asked to open
+        std::string sharedFramesName_;
+        FramePublisher framePublisher_;
+        QuiescenceMode quiescenceMode_;
+        /// @brief parameters since which the rests are tracked, they stay valid while the parameters forces depend on stay the same
+        std::shared_ptr<const SimulationParameters> restParameters_;
+        /// @brief should all particles settle anew during this tick
+        bool resettingRests_;
+        /// @brief rest of each particle, split by species in the same order as particles_, empty if no forces are reused
+        std::vector<RestVector> rests_;
+        /// @brief for each chunk, have all its particles been at rest for long enough
+        std::vector<char> quietChunks_;
+        /// @brief for each chunk, did a chunk within its reach lose all its particles since the previous tick
+        std::vector<char> disturbedChunks_;
+        /// @brief for each chunk, are its forces reused during this tick, or could they have been during a refresh
+        std::vector<char> reusableChunks_;
+        /// @brief occupied chunks of the previous tick, sorted by key
+        std::vector<ChunkCount> previousChunks_;
+        /// @brief chunk count the keys of previousChunks_ were computed with
+        size_t previousChunkCount_;
+        /// @brief reused and measured forces of each region during this tick
+        std::vector<QuiescenceCounts> regionQuiescence_;
+        /// @brief particle updates with reused forces since the forces last changed
+        size_t reusedUpdates_;
+        /// @brief all particle updates since the forces last changed
+        size_t totalUpdates_;
+        /// @brief reused forces and their error, empty if no forces are reused
+        std::optional<QuiescenceReport> quiescenceReport_;
+        /// @brief create or destroy particles to match counts specified in options
+        void updateParticleCounts();
+        /// @brief remove particles of given species with ids not less than count
+        /// @param species species id
+        /// @param count particle count to keep
+        void removeParticles(size_t species, size_t count);
+        /// @brief match worker threads to the parameters
+        void updateWorkers();
+        /// @brief assign particles to corresponding chunks, split them into regions and reorder them if they got too scattered in memory
+        void updateChunks();
+        /// @brief reorder particles in memory to follow the order of chunks, each region is copied by its own worker
+        void reorderParticles();
+        /// @brief pick the quiescence mode of this tick and let all particles settle anew if parameters forces depend on changed
+        void updateRests();
+        /// @brief update rests of all particles and find chunks whose particles have all been at rest for long enough, each region by its own worker
+        /// @details a chunk which lost or gained particles since the previous tick isn't quiet, chunks within reach of a chunk which lost all of them are disturbed
+        void updateQuietChunks();
+        /// @brief sum reused and measured forces of all regions into the quiescence report
+        void updateQuiescenceReport();
+        /// @brief do forces computed with given parameters stay the same with the other parameters
+        static bool hasSameForces(const SimulationParameters& parameters, const SimulationParameters& other);
+        /// @brief split the world into one region per worker thread
+        void updateRegions();
+        /// @brief update acceleration, velocity and position of each particle, each region in a separate task
+        void updateParticles();
+        /// @brief update forces of a region, then wait only for regions reading its particles to finish their forces and update its positions
+        /// @param region region index
+        void updateRegion(size_t region);
+        /// @brief update acceleration of each particle of a region and record which regions it reads
+        /// @tparam Law force law policy
+        /// @tparam SpeciesCount number of species known at compile time, 0 for any number
+        /// @param region region index
+        template <class Law, size_t SpeciesCount>
+        void updateRegionForces(size_t region);
+        /// @brief get updateRegionForces instantiated for a force law and the closest species count it is specialised for
+        /// @tparam Law force law policy
+        /// @param speciesCount number of species
+        template <class Law>
+        static RegionForces selectRegionForces(size_t speciesCount);
+        /// @brief update velocity and position of each particle of a region, measuring kinetic energy if observables are measured
+        /// @param region region index
+        void updateRegionPositions(size_t region);
+        /// @brief sum observables of all regions and queue them to be written
+        void updateObservables();
+        /// @brief place newly created particles of given species at random positions
+        /// @param species species id
+        /// @param first index of the first new particle
+        void spawnParticles(size_t species, size_t first);
+        /// @brief get random position of a particle, always the same for given seed, species and particle id
+        /// @param species species id
+        /// @param id particle id
+        sf::Vector2f getSpawnPosition(size_t species, size_t id) const;
+        /// @brief recompute interactions from current parameters
+        void updateInteractions();
+        /// @brief sample a force law into the tables of all interactions
+        /// @tparam Law force law policy
+        template <class Law>
+        void updateForceTables();
+        /// @brief get the largest force error of the tables of all interactions
+        /// @tparam Law force law policy the tables approximate
+        template <class Law>
+        float getForceTableError() const;
+        /// @brief stage the next tile of a region and link its chunks to the chunks within their reach, recording the regions of chunks within reach
+        /// @details chunks whose forces are reused get no links
+        /// @param begin index of the first chunk of the tile
+        /// @param region region of the tile
+        /// @param tile buffer to stage the tile into
+        /// @return index after the last chunk of the tile
+        size_t stageTile(size_t begin, size_t region, TileBuffer& tile);
+        /// @brief compute forces of all links of a staged tile and set them as accelerations of its particles
+        /// @tparam Law force law policy
+        /// @tparam SpeciesCount number of species known at compile time, 0 for any number
+        /// @param tile staged tile
+        /// @param interactions interactions indexed by species id * species count + other species id
+        /// @param observables observables to count the pairs into, nullptr if they aren't measured
+        /// @param quiescence counts to compare forces which could have been reused with the recomputed ones into, nullptr unless this tick refreshes them
+        template <class Law, size_t SpeciesCount>
+        void updateTile(TileBuffer& tile, const Interaction* interactions, TickObservables* observables, QuiescenceCounts* quiescence);
+        /// @brief add force of other particle to the force of a given particle
+        /// @tparam Law force law policy
+        /// @param position position of the particle
+        /// @param force force of the particle summed so far
+        /// @param interaction interaction of the particle's species with the other particle's species
+        /// @param otherPos position of the other particle
+        /// @param observables observables to count the pair into, nullptr if they aren't measured
+        template <class Law>
+        void updateParticle(sf::Vector2f position, sf::Vector2f& force, const Interaction& interaction, sf::Vector2f otherPos, TickObservables* observables);
+    public:
+        Simulation(const Options& options);
+        /// @brief initialize simulation
+        void init();
+        /// @brief simulate one step of simulation
+        void tick();
+        /// @brief get time simulated
+        inline double getTime() const { return simTime_; }
+        /// @brief get number of ticks simulated
+        inline size_t getTickCount() const { return tickCount_; }
+        /// @brief get real time spent in each phase of the last tick
+        inline const TickPhaseTimes& getPhaseTimes() const { return phaseTimes_; }
+        /// @brief get the largest difference between the tabulated force and the exact force law beyond the first table entry, 0 if forces aren't tabulated
+        float getForceTableError() const;
+        /// @brief get a hash of positions and velocities of all particles, equal for bit for bit equal states
+        uint64_t getStateChecksum() const;
+        /// @brief get particles split by species, their order changes between ticks
+        inline const std::vector<ParticleVector>& getParticles() const { return particles_; }
+        /// @brief get the chunk map of the last tick, built before particles moved during it, empty before the first tick
+        inline const ChunkMap& getChunkMap() const { return chunks_; }
+        /// @brief get result of the last cluster analysis, empty if there was none yet
+        inline const std::optional<ClusterReport>& getClusterReport() const { return clusterReport_; }
+        /// @brief get reused forces and their error, empty if no forces are reused
+        inline const std::optional<QuiescenceReport>& getQuiescenceReport() const { return quiescenceReport_; }
+        /// @brief get stable ids of particles returned by getParticles, in the same order
+        inline const std::vector<ParticleIdVector>& getParticleIds() const { return ids_; }
+    };
+}
 #endif
\ No newline at end of file
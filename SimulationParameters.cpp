@@ -0,0 +1,19 @@
+#include "SimulationParameters.h"
+namespace ParticleLife {
+    ParametersHandle::ParametersHandle() : current_() {}
+
+    ParametersHandle::ParametersHandle(const ParametersHandle& other) : current_(other.load()) {}
+
+    ParametersHandle& ParametersHandle::operator=(const ParametersHandle& other) {
+        store(other.load());
+        return *this;
+    }
+
+    std::shared_ptr<const SimulationParameters> ParametersHandle::load() const {
+        return current_.load(std::memory_order_acquire);
+    }
+
+    void ParametersHandle::store(std::shared_ptr<const SimulationParameters> parameters) {
+        current_.store(std::move(parameters), std::memory_order_release);
+    }
+}
\ No newline at end of file
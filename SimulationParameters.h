@@ -0,0 +1,84 @@
+#ifndef SIMULATION_PARAMETERS_H
+#define SIMULATION_PARAMETERS_H
+#include "ParticleSpecies.h"
+#include "WorkerPool.h"
+#include "ForceLaws.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+namespace ParticleLife {
+    /// @brief immutable copy of the options the simulation depends on
+    class SimulationParameters {
+    public:
+        /// @brief increases with every published change of the options
+        size_t version;
+        /// @brief size of simulation steps in seconds
+        float timeStep;
+        /// @brief width and height
+        float worldSize;
+        /// @brief portion of velocity left after one step
+        float frictionMultiplierPerTick;
+        /// @brief maximum repulsion strength (when two particles are on top of each other)
+        float repulsion;
+        /// @brief how the force between two particles depends on their distance
+        ForceLaw forceLaw;
+        /// @brief should forces be interpolated from tables instead of computed exactly
+        bool tabulatedForces;
+        /// @brief number of chunks along each axis
+        size_t chunkCount;
+        /// @brief width and height of one chunk
+        float chunkSize;
+        /// @brief list of species
+        std::vector<ParticleSpecies> species;
+        /// @brief chunk offsets sorted by distance from (0, 0) up to max chunk range
+        std::vector<sf::Vector2u> chunkPattern;
+        /// @brief should the simulation compute forces on multiple threads
+        bool parallel;
+        /// @brief seed of particle placement
+        uint64_t seed;
+        /// @brief should particles be reordered in memory to follow their chunks
+        bool reordering;
+        /// @brief number of worker threads, 0 for one per hardware thread
+        size_t threadCount;
+        /// @brief how worker threads are placed on cores
+        ThreadPlacement threadPlacement;
+        /// @brief particles closer than this to each other belong to the same cluster
+        float clusterLinkingDistance;
+        /// @brief ticks between cluster analyses, 0 to disable them
+        size_t clusterInterval;
+        /// @brief amount of closest chunks to check for particles within cluster linking distance
+        size_t clusterChunkRange;
+        /// @brief ticks between measurements of observables, 0 to disable them
+        size_t observablesInterval;
+        /// @brief file to write observables into, empty if they are disabled
+        std::string observablesFile;
+        /// @brief ticks between frames published into shared memory, 0 to disable them
+        size_t sharedFramesInterval;
+        /// @brief name of the shared memory region to publish frames into, empty if they are disabled
+        std::string sharedFramesName;
+        /// @brief particles staying within this distance of where they settled are at rest, 0 to compute all forces every tick
+        float quiescenceDistance;
+        /// @brief ticks all particles within reach of a chunk must be at rest before its forces are reused
+        size_t quiescenceTicks;
+        /// @brief ticks between passes recomputing all forces, which measure the error of the reused ones
+        size_t quiescenceRefreshInterval;
+    };
+
+    /// @brief holds the latest published parameters, can be read and replaced from different threads
+    class ParametersHandle {
+    private:
+        std::atomic<std::shared_ptr<const SimulationParameters>> current_;
+    public:
+        ParametersHandle();
+        /// @brief the copy refers to the same parameters, but replacing them in one handle doesn't affect the other
+        ParametersHandle(const ParametersHandle& other);
+        ParametersHandle& operator=(const ParametersHandle& other);
+        /// @brief get the latest published parameters
+        std::shared_ptr<const SimulationParameters> load() const;
+        /// @brief publish new parameters
+        void store(std::shared_ptr<const SimulationParameters> parameters);
+    };
+}
+#endif
\ No newline at end of file
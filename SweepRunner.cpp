@@ -0,0 +1,104 @@
+#include "SweepRunner.h"
+#include "Simulation.h"
+#include <execution>
+#include <algorithm>
+#include <iomanip>
+namespace ParticleLife {
+    constexpr size_t METRIC_GRID_SIZE = 16;
+    constexpr int PARAMETER_PRECISION = 12;
+
+    SweepRunner::SweepRunner(size_t ticks) : ticks_(ticks), parameterName_(), jobs_() {}
+
+    void SweepRunner::addRandomSample(const Options& base, size_t runs, size_t seed)
+    {
+        parameterName_ = "seed";
+        for (size_t i = 0; i < runs; i++)
+        {
+            Job job = { (double)(seed + i), base, {} };
+            // particles are placed by the seed too, so the seed alone reproduces the job
+            job.options.setSeed(seed + i);
+            job.options.randomizeInteractions();
+            jobs_.push_back(std::move(job));
+        }
+    }
+
+    void SweepRunner::addAttractionGrid(const Options& base, size_t species, size_t otherSpecies, float maxAttraction, size_t steps)
+    {
+        parameterName_ = "attraction";
+        for (size_t i = 0; i < steps; i++)
+        {
+            float attraction = steps == 1 ? 0 : -maxAttraction + 2 * maxAttraction * i / (steps - 1);
+            Job job = { attraction, base, {} };
+            job.options.setSpeciesAttraction(species, otherSpecies, attraction);
+            jobs_.push_back(std::move(job));
+        }
+    }
+
+    void SweepRunner::run()
+    {
+        // each job runs single threaded, so the jobs themselves can occupy all cores without oversubscription
+        for (auto&& job : jobs_) {
+            job.options.setParallel(false);
+            job.options.setObservables(0, "");
+            job.options.setSharedFrames(0, "");
+        }
+        std::for_each(
+            std::execution::par,
+            jobs_.begin(),
+            jobs_.end(),
+            [this](auto&& job)
+            {
+                runJob(job);
+            });
+    }
+
+    void SweepRunner::runJob(Job& job) const
+    {
+        Simulation simulation(job.options);
+        simulation.init();
+        for (size_t i = 0; i < ticks_; i++)
+        {
+            simulation.tick();
+        }
+
+        std::vector<size_t> cells(METRIC_GRID_SIZE * METRIC_GRID_SIZE);
+        float cellSize = job.options.getWorldSize() / METRIC_GRID_SIZE;
+        double speedSum = 0;
+        size_t particleCount = 0;
+        for (auto&& s : simulation.getParticles()) {
+            for (auto&& p : s) {
+                sf::Vector2f v = p.getVelocity();
+                speedSum += std::sqrtf(v.x * v.x + v.y * v.y);
+                size_t x = std::min((size_t)(p.getPosition().x / cellSize), METRIC_GRID_SIZE - 1);
+                size_t y = std::min((size_t)(p.getPosition().y / cellSize), METRIC_GRID_SIZE - 1);
+                cells[x * METRIC_GRID_SIZE + y]++;
+                particleCount++;
+            }
+        }
+
+        double mean = (double)particleCount / cells.size();
+        double variance = 0;
+        size_t occupied = 0;
+        for (auto&& c : cells) {
+            variance += (c - mean) * (c - mean);
+            if (c > 0)
+                occupied++;
+        }
+        variance /= cells.size();
+
+        job.result.meanSpeed = particleCount == 0 ? 0 : (float)(speedSum / particleCount);
+        job.result.occupiedFraction = (float)occupied / cells.size();
+        job.result.dispersion = particleCount == 0 ? 0 : (float)(variance / mean);
+    }
+
+    void SweepRunner::writeResults(std::ostream& out) const
+    {
+        std::streamsize defaultPrecision = out.precision();
+        out << "run\t" << parameterName_ << "\tmean speed\toccupied fraction\tdispersion" << std::endl;
+        for (size_t i = 0; i < jobs_.size(); i++)
+        {
+            const Job& job = jobs_[i];
+            out << i << "\t" << std::setprecision(PARAMETER_PRECISION) << job.parameter << std::setprecision(defaultPrecision) << "\t" << job.result.meanSpeed << "\t" << job.result.occupiedFraction << "\t" << job.result.dispersion << std::endl;
+        }
+    }
+}
\ No newline at end of file
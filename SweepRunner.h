@@ -0,0 +1,56 @@
+#ifndef SWEEP_RUNNER_H
+#define SWEEP_RUNNER_H
+#include "Options.h"
+#include <vector>
+#include <string>
+#include <ostream>
+namespace ParticleLife {
+    /// @brief cheap structure metrics of a finished simulation run
+    struct SweepResult {
+        /// @brief average particle speed
+        float meanSpeed;
+        /// @brief portion of metric grid cells containing at least one particle
+        float occupiedFraction;
+        /// @brief variance of particle counts per metric grid cell divided by their mean (1 for uniformly random particles, more for clustered ones)
+        float dispersion;
+    };
+
+    /// @brief runs many small independent headless simulations concurrently, one simulation per task
+    class SweepRunner {
+    private:
+        /// @brief one simulation to run
+        struct Job {
+            /// @brief value identifying the job in the results table
+            double parameter;
+            Options options;
+            SweepResult result;
+        };
+        /// @brief ticks to simulate in each job
+        size_t ticks_;
+        /// @brief name of the swept parameter
+        std::string parameterName_;
+        std::vector<Job> jobs_;
+        /// @brief simulate a job and measure its result
+        void runJob(Job& job) const;
+    public:
+        /// @param ticks number of ticks to simulate in each job
+        SweepRunner(size_t ticks);
+        /// @brief prepare jobs with randomly generated attraction strengths and ranges
+        /// @param base options to copy everything else from
+        /// @param runs number of jobs
+        /// @param seed seed of the first job, each next one gets the next seed, which places its particles and draws its interactions
+        void addRandomSample(const Options& base, size_t runs, size_t seed);
+        /// @brief prepare jobs with attraction strength of one species to another spread evenly between -maxAttraction and maxAttraction
+        /// @param base options to copy everything else from
+        /// @param species species id
+        /// @param otherSpecies other species id
+        /// @param maxAttraction maximum attraction strength magnitude
+        /// @param steps number of jobs
+        void addAttractionGrid(const Options& base, size_t species, size_t otherSpecies, float maxAttraction, size_t steps);
+        /// @brief run all jobs on all available threads
+        void run();
+        /// @brief write a tab separated table of the results, one line per job
+        void writeResults(std::ostream& out) const;
+    };
+}
+#endif
\ No newline at end of file
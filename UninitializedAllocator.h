@@ -0,0 +1,27 @@
+#ifndef UNINITIALIZED_ALLOCATOR_H
+#define UNINITIALIZED_ALLOCATOR_H
+#include <memory>
+#include <utility>
+namespace ParticleLife {
+    /// @brief allocator which leaves value initialized elements (e.g. added by resize) unconstructed and untouched,
+    /// so memory pages are first written (and placed on a NUMA node) by whichever thread fills them in later, only for trivially copyable types
+    template <class T>
+    class UninitializedAllocator : public std::allocator<T> {
+    public:
+        template <class U>
+        struct rebind {
+            using other = UninitializedAllocator<U>;
+        };
+        UninitializedAllocator() = default;
+        template <class U>
+        UninitializedAllocator(const UninitializedAllocator<U>&) noexcept {}
+        /// @brief leave the element unconstructed, it has to be assigned before it is read
+        template <class U>
+        void construct(U*) noexcept {}
+        template <class U, class... Args>
+        void construct(U* p, Args&&... args) {
+            ::new((void*)p) U(std::forward<Args>(args)...);
+        }
+    };
+}
+#endif
@@ -0,0 +1,176 @@
+#include "WorkerPool.h"
+#include <cstdint>
+#include <algorithm>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <filesystem>
+#include <cctype>
+#include <string>
+#endif
+namespace ParticleLife {
+    /// @brief size of a transparent huge page on x86-64 Linux
+    constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    WorkerPool::WorkerPool() :
+        threads_(), mutex_(), start_(), finish_(), task_(nullptr), taskCount_(0), batch_(0), running_(0), stopping_(false), placement_(ThreadPlacement::Free) {}
+
+    WorkerPool::~WorkerPool() {
+        stop();
+    }
+
+    bool WorkerPool::resize(size_t count, ThreadPlacement placement) {
+        if (count == threads_.size() && placement == placement_)
+            return true;
+        stop();
+        placement_ = placement;
+        size_t batch;
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = false;
+            batch = batch_;
+        }
+        // new workers must not take a batch which already ran for a task
+        for (size_t i = 0; i < count; i++)
+        {
+            threads_.emplace_back(&WorkerPool::work, this, i, count, batch);
+        }
+        if (placement_ == ThreadPlacement::Free || count == 0)
+            return true;
+        // workers are pinned before they get their first batch, so all memory they touch is placed on their node,
+        // consecutive workers update neighbouring regions, so they are kept on the same node
+        std::vector<size_t> cores = getAllowedCores();
+        bool pinned = !cores.empty();
+        for (size_t i = 0; i < count && !cores.empty(); i++)
+        {
+            pinned = pinThread(threads_[i], cores[i % cores.size()]) && pinned;
+        }
+        return pinned;
+    }
+
+    void WorkerPool::run(size_t count, const std::function<void(size_t)>& task) {
+        if (threads_.empty()) {
+            for (size_t i = 0; i < count; i++)
+            {
+                task(i);
+            }
+            return;
+        }
+        std::unique_lock lock(mutex_);
+        task_ = &task;
+        taskCount_ = count;
+        running_ = threads_.size();
+        batch_++;
+        start_.notify_all();
+        finish_.wait(lock, [this] { return running_ == 0; });
+        task_ = nullptr;
+    }
+
+    void WorkerPool::work(size_t worker, size_t workerCount, size_t batch) {
+        while (true) {
+            const std::function<void(size_t)>* task;
+            size_t taskCount;
+            {
+                std::unique_lock lock(mutex_);
+                start_.wait(lock, [this, batch] { return stopping_ || batch_ != batch; });
+                if (stopping_)
+                    return;
+                batch = batch_;
+                task = task_;
+                taskCount = taskCount_;
+            }
+            for (size_t i = worker; i < taskCount; i += workerCount)
+            {
+                (*task)(i);
+            }
+            std::lock_guard lock(mutex_);
+            if (--running_ == 0)
+                finish_.notify_one();
+        }
+    }
+
+    void WorkerPool::stop() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        start_.notify_all();
+        for (auto&& thread : threads_) {
+            thread.join();
+        }
+        threads_.clear();
+    }
+
+    std::vector<size_t> WorkerPool::getAllowedCores() {
+        // pairs of NUMA node and core, sorted so that cores of the same node follow each other
+        std::vector<std::pair<size_t, size_t>> nodeCores;
+#if defined(_WIN32)
+        DWORD_PTR processMask, systemMask;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+            for (size_t core = 0; core < sizeof(DWORD_PTR) * 8; core++)
+            {
+                if ((processMask >> core & 1) == 0)
+                    continue;
+                UCHAR node = 0;
+                GetNumaProcessorNode((UCHAR)core, &node);
+                nodeCores.emplace_back(node, core);
+            }
+        }
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (size_t core = 0; core < CPU_SETSIZE; core++)
+            {
+                if (!CPU_ISSET(core, &set))
+                    continue;
+                // the node of a core is linked in its sysfs directory as "node<index>"
+                size_t node = 0;
+                std::error_code error;
+                for (auto&& entry : std::filesystem::directory_iterator("/sys/devices/system/cpu/cpu" + std::to_string(core), error)) {
+                    std::string name = entry.path().filename().string();
+                    if (name.rfind("node", 0) == 0 && name.size() > 4 && std::isdigit((unsigned char)name[4])) {
+                        node = std::stoul(name.substr(4));
+                        break;
+                    }
+                }
+                nodeCores.emplace_back(node, core);
+            }
+        }
+#endif
+        std::sort(nodeCores.begin(), nodeCores.end());
+        std::vector<size_t> cores;
+        for (auto&& nodeCore : nodeCores) {
+            cores.push_back(nodeCore.second);
+        }
+        return cores;
+    }
+
+    bool WorkerPool::pinThread(std::thread& thread, size_t core) {
+#if defined(_WIN32)
+        return SetThreadAffinityMask((HANDLE)thread.native_handle(), (DWORD_PTR)1 << core) != 0;
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    void WorkerPool::adviseHugePages(void* data, size_t bytes) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        // only whole huge pages inside the range can be advised
+        uintptr_t begin = ((uintptr_t)data + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+        uintptr_t end = ((uintptr_t)data + bytes) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+        if (begin < end)
+            madvise((void*)begin, end - begin, MADV_HUGEPAGE);
+#endif
+    }
+}
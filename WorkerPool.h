@@ -0,0 +1,75 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+namespace ParticleLife {
+    /// @brief how worker threads are placed on the cores
+    enum class ThreadPlacement {
+        /// @brief threads are scheduled freely by the operating system
+        Free,
+        /// @brief each thread is pinned to its own core of those the process may run on, consecutive threads on cores of the same NUMA node
+        Pinned,
+        /// @brief threads are pinned as with Pinned and particles are stored in huge memory pages
+        PinnedHugePages
+    };
+
+    /// @brief persistent worker threads, each task index always runs on the same worker, so data it first touches stays local to its core
+    class WorkerPool {
+    private:
+        std::vector<std::thread> threads_;
+        std::mutex mutex_;
+        /// @brief signals workers that a new batch of tasks is ready or that they should stop
+        std::condition_variable start_;
+        /// @brief signals the caller that the last worker finished its tasks
+        std::condition_variable finish_;
+        /// @brief task of the current batch
+        const std::function<void(size_t)>* task_;
+        /// @brief number of tasks in the current batch
+        size_t taskCount_;
+        /// @brief increases with every batch, workers wait for it to change
+        size_t batch_;
+        /// @brief number of workers still running tasks of the current batch
+        size_t running_;
+        bool stopping_;
+        ThreadPlacement placement_;
+        /// @brief loop of one worker thread
+        /// @param worker index of the worker
+        /// @param workerCount number of workers in the pool
+        /// @param batch batch already run before the worker started, the worker waits for the next one
+        void work(size_t worker, size_t workerCount, size_t batch);
+        /// @brief stop and join all workers
+        void stop();
+        /// @brief get the logical cores the process may run on, grouped by NUMA node
+        static std::vector<size_t> getAllowedCores();
+        /// @brief restrict a thread to a single core
+        /// @param core index of the logical core
+        /// @return did the operating system accept it
+        static bool pinThread(std::thread& thread, size_t core);
+    public:
+        WorkerPool();
+        ~WorkerPool();
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+        /// @brief replace the workers, does nothing if the pool already matches
+        /// @param count number of worker threads, with 0 tasks run on the calling thread
+        /// @param placement how to place the threads on cores
+        /// @return false if some threads couldn't be pinned, they are then scheduled freely
+        bool resize(size_t count, ThreadPlacement placement);
+        /// @brief get number of worker threads
+        inline size_t getThreadCount() const { return threads_.size(); }
+        /// @brief get how the threads are placed on cores
+        inline ThreadPlacement getPlacement() const { return placement_; }
+        /// @brief run task(i) for each i from 0 to count - 1 and wait for all of them to finish, task i runs on worker i % thread count
+        /// @param count number of tasks
+        /// @param task function taking the task index
+        void run(size_t count, const std::function<void(size_t)>& task);
+        /// @brief ask the operating system to back given memory with huge pages, only has effect on Linux
+        /// @param data start of the memory
+        /// @param bytes size of the memory
+        static void adviseHugePages(void* data, size_t bytes);
+    };
+}
+#endif
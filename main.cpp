@@ -1,7 +1,7 @@
-#include <SFML/Graphics.hpp>
-#include "ProgramManager.h"
-int main()
-{
-    ParticleLife::ProgramManager p{};
-    p.run();
-}
+#include <SFML/Graphics.hpp>
+#include "ProgramManager.h"
+int main()
+{
+    ParticleLife::ProgramManager p{};
+    p.run();
+}
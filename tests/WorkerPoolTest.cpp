@@ -0,0 +1,48 @@
+// Regression check of WorkerPool, built separately from the application:
+// g++ -std=c++20 -I.. WorkerPoolTest.cpp ../WorkerPool.cpp -lpthread -o WorkerPoolTest
+#include "WorkerPool.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+using namespace ParticleLife;
+
+/// @brief run a batch and check that every task ran exactly once
+bool runBatch(WorkerPool& pool, size_t count)
+{
+    std::vector<std::atomic<size_t>> runs(count);
+    pool.run(count, [&runs](size_t i) { runs[i]++; });
+    for (auto&& r : runs) {
+        if (r != 1)
+            return false;
+    }
+    return true;
+}
+
+/// @brief resize the pool and give the new workers time to start before the next batch
+/// @return could the workers be placed
+bool resize(WorkerPool& pool, size_t count, ThreadPlacement placement)
+{
+    bool placed = pool.resize(count, placement);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    return placed;
+}
+
+int main()
+{
+    WorkerPool pool;
+    bool success = true;
+    resize(pool, 2, ThreadPlacement::Free);
+    success = success && runBatch(pool, 8);
+    // workers started after a batch ran must wait for the next one instead of taking the finished one
+    resize(pool, 3, ThreadPlacement::Free);
+    success = success && runBatch(pool, 8);
+    // cores are picked from the affinity mask of the process, so pinning succeeds even when run under taskset
+    success = resize(pool, 3, ThreadPlacement::Pinned) && success;
+    success = success && runBatch(pool, 5);
+    resize(pool, 0, ThreadPlacement::Free);
+    success = success && runBatch(pool, 4);
+    resize(pool, 1, ThreadPlacement::Free);
+    success = success && runBatch(pool, 4);
+    std::cout << (success ? "WorkerPool: OK" : "WorkerPool: FAILED") << std::endl;
+    return success ? 0 : 1;
+}